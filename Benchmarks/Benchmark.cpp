@@ -0,0 +1,646 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "FlowField.h"
+#include "GenerationCache.h"
+#include "GenerationTask.h"
+#include "InteractableSpawner.h"
+#include "LandmarkPlacer.h"
+#include "Pathfinder.h"
+#include "RegionMap.h"
+#include "Generator.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+using namespace WorldGenerator;
+
+// Every allocation made by the process goes through these, so each case can report how many it made
+static std::atomic<unsigned long long> g_AllocationCount(0);
+static std::atomic<unsigned long long> g_AllocatedBytes(0);
+
+void* operator new(size_t size)
+{
+	g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+struct BenchmarkResult
+{
+	std::string Name;
+	std::string Group;
+	unsigned int Iterations;
+	double MedianSeconds;
+	double MinSeconds;
+	unsigned long long CellsPerIteration;
+	unsigned long long AllocationsPerIteration;
+	unsigned long long BytesPerIteration;
+	long PeakRssKB;
+};
+
+struct BenchmarkOptions
+{
+	BenchmarkOptions()
+	{
+		Repeats = 5;
+		bQuick = false;
+	}
+
+	unsigned int Repeats;
+	bool bQuick;
+	std::string Filter;
+	std::string JsonPath;
+};
+
+static long GetPeakRssKB()
+{
+#ifdef __linux__
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return usage.ru_maxrss;
+#endif
+	return -1;
+}
+
+// Times body repeatedly. body returns the number of cells it produced
+template<typename Body>
+static void Run(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results, const std::string& group, const std::string& name, Body body)
+{
+	std::string fullName = group + "/" + name;
+	if (!options.Filter.empty() && fullName.find(options.Filter) == std::string::npos)
+		return;
+
+	// Warm up caches and lazily built tables before measuring
+	body();
+
+	std::vector<double> samples;
+	samples.reserve(options.Repeats);
+	unsigned long long cells = 0;
+	unsigned long long allocations = g_AllocationCount.load();
+	unsigned long long bytes = g_AllocatedBytes.load();
+	for (unsigned int repeat = 0; repeat < options.Repeats; repeat++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		cells = body();
+		samples.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	BenchmarkResult result;
+	result.Name = fullName;
+	result.Group = group;
+	result.Iterations = options.Repeats;
+	std::sort(samples.begin(), samples.end());
+	result.MedianSeconds = samples[samples.size() / 2];
+	result.MinSeconds = samples.front();
+	result.CellsPerIteration = cells;
+	result.AllocationsPerIteration = (g_AllocationCount.load() - allocations) / options.Repeats;
+	result.BytesPerIteration = (g_AllocatedBytes.load() - bytes) / options.Repeats;
+	result.PeakRssKB = GetPeakRssKB();
+	results.push_back(result);
+
+	// The table goes to stderr when stdout carries the JSON, so the JSON stays parseable
+	double cellsPerSecond = result.MedianSeconds > 0 ? cells / result.MedianSeconds : 0;
+	std::fprintf((options.JsonPath == "-") ? stderr : stdout, "%-60s %10.3f ms %14.0f cells/s %10llu allocs %12llu bytes %8ld KB rss\n", fullName.c_str(), result.MedianSeconds * 1000.0,
+		cellsPerSecond, result.AllocationsPerIteration, result.BytesPerIteration, result.PeakRssKB);
+}
+
+struct GeneratorCase
+{
+	int MapSize;
+	int Walkers;
+	int PathLength;
+	int Divergence;
+};
+
+static void BenchmarkGenerator(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// Sweep one setting at a time around a baseline
+	const GeneratorCase baseline = { 1024, 8, 4000, 50 };
+	std::vector<GeneratorCase> cases;
+	cases.push_back(baseline);
+	for (int size : { 256, 4096 })
+		cases.push_back({ size, baseline.Walkers, baseline.PathLength, baseline.Divergence });
+	for (int walkers : { 2, 32, 1024 })
+		cases.push_back({ baseline.MapSize, walkers, baseline.PathLength, baseline.Divergence });
+	for (int length : { 500, 20000 })
+		cases.push_back({ baseline.MapSize, baseline.Walkers, length, baseline.Divergence });
+	for (int divergence : { 10, 90 })
+		cases.push_back({ baseline.MapSize, baseline.Walkers, baseline.PathLength, divergence });
+
+	for (const GeneratorCase& settings : cases)
+	{
+		int scale = options.bQuick ? 4 : 1;
+		Generator generator("benchmark");
+		generator.SetMapSize(settings.MapSize, settings.MapSize);
+		generator.SetMaxWalkers(settings.Walkers);
+		generator.SetMaxPathLength(settings.PathLength / scale);
+		generator.SetPathDivergencePercent(settings.Divergence);
+
+		char name[128];
+		std::snprintf(name, sizeof(name), "size=%d,walkers=%d,length=%d,divergence=%d", settings.MapSize, settings.Walkers, settings.PathLength / scale, settings.Divergence);
+
+		WorldGrid grid;
+		std::pair<int, int> start = std::make_pair(settings.MapSize / 2, settings.MapSize / 2);
+		Run(options, results, "GenerateMap", name, [&]() {
+			generator.GenerateMap(grid, start, 12345);
+			return (unsigned long long)grid.size();
+		});
+	}
+}
+
+static void BenchmarkWalk(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// Carves into a reused canvas. What allocations remain are the walker arrays growing, so
+	// the count has to stay flat as paths get longer
+	Generator generator("benchmark");
+	generator.SetMapSize(1024, 1024);
+	generator.SetMaxWalkers(32);
+
+	for (int length : { 1000, 16000 })
+	{
+		generator.SetMaxPathLength(options.bQuick ? length / 4 : length);
+
+		PaletteGrid canvas;
+		std::pair<int, int> rowRange;
+		std::pair<int, int> columnRange;
+		Run(options, results, "CarveMap", "length=" + std::to_string(generator.GetMaxPathLength()), [&]() {
+			generator.CarveMap(canvas, std::make_pair(512, 512), 12345, rowRange, columnRange);
+			return (unsigned long long)(rowRange.second - rowRange.first + 1) * (columnRange.second - columnRange.first + 1);
+		});
+	}
+}
+
+static void BenchmarkTask(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// The GenerateMap baseline driven a slice at a time. Compared with GenerateMap, shows what
+	// stopping and resuming costs at each slice size
+	Generator generator("benchmark");
+	generator.SetMapSize(1024, 1024);
+	generator.SetMaxWalkers(8);
+	generator.SetMaxPathLength(options.bQuick ? 1000 : 4000);
+
+	for (unsigned long long steps : { 64ull, 1024ull, 0ull })
+	{
+		WorldGrid grid;
+		Run(options, results, "GenerationTask", "steps=" + std::to_string(steps), [&]() {
+			GenerationTask task(generator, std::make_pair(512, 512), 12345);
+			while (task.Step(GenerationBudget(steps)))
+			{
+			}
+
+			std::swap(grid, task.GetGrid());
+			return (unsigned long long)grid.size();
+		});
+	}
+}
+
+static void BenchmarkCache(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// The GenerateMap baseline served from a warm cache, from memory and from disk
+	Generator generator("benchmark");
+	generator.SetMapSize(1024, 1024);
+	generator.SetMaxWalkers(8);
+	generator.SetMaxPathLength(options.bQuick ? 1000 : 4000);
+	std::pair<int, int> start = std::make_pair(512, 512);
+
+	WorldGrid grid;
+	GenerationCache memoryCache(256 << 20);
+	memoryCache.GenerateMap(generator, grid, start, 12345);
+	Run(options, results, "GenerationCache", "memory", [&]() {
+		memoryCache.GenerateMap(generator, grid, start, 12345);
+		return (unsigned long long)grid.size();
+	});
+
+	// A zero byte budget sends every lookup to the file
+	GenerationCache diskCache(0, ".");
+	diskCache.GenerateMap(generator, grid, start, 12345);
+	Run(options, results, "GenerationCache", "disk", [&]() {
+		diskCache.GenerateMap(generator, grid, start, 12345);
+		return (unsigned long long)grid.size();
+	});
+
+	char path[32];
+	std::snprintf(path, sizeof(path), "%016llx.wgm", GenerationCache::GetKey(generator, start, 12345));
+	std::remove(path);
+}
+
+static void BenchmarkMagnification(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// Carve once, then time the crop, magnify and decode step that GenerateMap finishes with
+	Generator generator("benchmark");
+	generator.SetMapSize(2048, 2048);
+	generator.SetMaxWalkers(8);
+	generator.SetMaxPathLength(options.bQuick ? 2000 : 8000);
+
+	PaletteGrid canvas;
+	std::pair<int, int> rowRange;
+	std::pair<int, int> columnRange;
+	generator.CarveMap(canvas, std::make_pair(1024, 1024), 12345, rowRange, columnRange);
+	const Cell* palette = canvas.GetCellSet()->GetPalette();
+
+	for (int magnification : { 1, 2, 4, 8 })
+	{
+		WorldGrid grid;
+		Run(options, results, "ProcessResults", "magnification=" + std::to_string(magnification), [&]() {
+			MagnifiedView<unsigned char> view(canvas, rowRange, columnRange, std::make_pair(magnification, magnification));
+			view.Materialize(grid, [palette](unsigned char index) { return palette[index]; });
+			grid.RebuildLayers();
+			return (unsigned long long)grid.size();
+		});
+	}
+}
+
+static void BenchmarkLandmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	for (int size : { 16, 64, 256 })
+	{
+		LandmarkTemplate landmark(size, size, size, size, "benchmark");
+		WorldGrid grid;
+		unsigned int count = options.bQuick ? 10 : 100;
+		Run(options, results, "GenerateLandmark", "size=" + std::to_string(size), [&]() {
+			unsigned long long cells = 0;
+			for (unsigned int seed = 1; seed <= count; seed++)
+			{
+				landmark.GenerateLandmark(grid, seed);
+				cells += grid.size();
+			}
+
+			return cells;
+		});
+	}
+}
+
+static void BenchmarkLandmarkPlacement(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// Places small and medium landmarks into a 4096 map, sparse and close to full. Time should
+	// follow the landmark count rather than the map size
+	LandmarkTemplate small(3, 6, 3, 6, "benchmark");
+	LandmarkTemplate medium(8, 16, 8, 16, "benchmark");
+	ThreadPool pool(0);
+
+	for (unsigned int count : { 10000u, 200000u })
+	{
+		LandmarkPlacer placer;
+		placer.AddLandmarks(small, options.bQuick ? count / 4 : count);
+		placer.AddLandmarks(medium, (options.bQuick ? count / 4 : count) / 10);
+
+		// Placing again stamps the same landmarks over themselves, so the grid needs no resetting
+		WorldGrid grid(4096, 4096, Cell(0, true, CellType::Ground));
+		std::vector<LandmarkPlacement> placements;
+		Run(options, results, "PlaceLandmarks", "count=" + std::to_string(placer.GetLandmarkCount()), [&]() {
+			placer.Place(grid, 12345, placements, &pool);
+			unsigned long long cells = 0;
+			for (const LandmarkPlacement& placement : placements)
+			{
+				cells += (unsigned long long)placement.Roll.RowCount * placement.Roll.ColumnCount;
+			}
+
+			return cells;
+		});
+	}
+}
+
+static void BenchmarkInteractableSpawning(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// Spawns dense small interactables and sparse larger ones over an open map. Time should
+	// follow the area rather than the number of spawns already made. A capped interactable
+	// should stop once it has its spawns
+	ThreadPool pool(0);
+	Interactable dense;
+	dense.NumMaxSpawns = -1;
+	Interactable sparse;
+	sparse.RowCount = 2;
+	sparse.ColumnCount = 3;
+	sparse.Spacing = 12;
+	sparse.NumMaxSpawns = -1;
+
+	for (int size : { 512, 2048 })
+	{
+		InteractableSpawner spawner;
+		spawner.AddInteractable(sparse);
+		spawner.AddInteractable(dense);
+
+		WorldGrid grid(size, size, Cell(0, true, CellType::Ground));
+		std::vector<InteractableSpawn> spawns;
+		Run(options, results, "SpawnInteractables", "size=" + std::to_string(size), [&]() {
+			spawner.Spawn(grid, 12345, spawns, &pool);
+			return (unsigned long long)grid.size();
+		});
+	}
+
+	// A single spawn should take about as long on any size of map
+	for (int size : { 1024, 4096 })
+	{
+		Interactable single;
+		single.NumRequiredSpawns = 1;
+		InteractableSpawner spawner;
+		spawner.AddInteractable(single);
+
+		WorldGrid grid(size, size, Cell(0, true, CellType::Ground));
+		std::vector<InteractableSpawn> spawns;
+		Run(options, results, "SpawnInteractables", "single size=" + std::to_string(size), [&]() {
+			spawner.Spawn(grid, 12345, spawns, &pool);
+			return (unsigned long long)spawns.size();
+		});
+	}
+}
+
+static void BenchmarkRegions(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// Labels a generated map, which is one winding region, and scattered noise, which is
+	// hundreds of thousands of small ones
+	ThreadPool pool(0);
+
+	Generator generator("benchmark");
+	generator.SetMapSize(2048, 2048);
+	generator.SetMaxWalkers(64);
+	generator.SetMaxPathLength(options.bQuick ? 20000 : 80000);
+	WorldGrid generated;
+	generator.GenerateMap(generated, std::make_pair(1024, 1024), 12345);
+
+	BitGrid noise(2048, 2048);
+	Xoshiro256 rng = MakeEngine<Xoshiro256>(12345, 0);
+	for (int x = 0; x < (int)noise.RowCount(); x++)
+	{
+		for (unsigned int word = 0; word < noise.WordsPerRow(); word++)
+		{
+			noise.RowWords(x)[word] = rng() & rng();
+		}
+	}
+
+	RegionMap regions;
+	Run(options, results, "LabelRegions", "generated", [&]() {
+		regions.Build(generated, &pool);
+		return (unsigned long long)generated.size();
+	});
+
+	Run(options, results, "LabelRegions", "noise", [&]() {
+		regions.Build(noise, &pool);
+		return (unsigned long long)noise.RowCount() * noise.ColumnCount();
+	});
+}
+
+static void BenchmarkPathfinding(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// Batches of paths between random passable cells of a generated map. After the first
+	// batch the scratch is warm, so allocations should stay flat as the batch grows
+	ThreadPool pool(0);
+	Generator generator("benchmark");
+	generator.SetMapSize(1024, 1024);
+	generator.SetMaxWalkers(64);
+	generator.SetMaxPathLength(40000);
+	WorldGrid grid;
+	generator.GenerateMap(grid, std::make_pair(512, 512), 12345);
+
+	std::vector<std::pair<int, int>> cells;
+	for (int x = 0; x < (int)grid.RowCount(); x++)
+	{
+		for (int y = 0; y < (int)grid.ColumnCount(); y++)
+		{
+			if (grid.IsPassable(x, y))
+				cells.push_back(std::make_pair(x, y));
+		}
+	}
+
+	std::vector<PathQuery> queries(options.bQuick ? 100 : 1000);
+	Xoshiro256 rng = MakeEngine<Xoshiro256>(12345, 0);
+	for (PathQuery& query : queries)
+	{
+		query.Start = cells[UniformRange(rng, 0, (int)cells.size() - 1)];
+		query.Goal = cells[UniformRange(rng, 0, (int)cells.size() - 1)];
+	}
+
+	Pathfinder pathfinder(grid);
+	PathBatch batch;
+	for (PathAlgorithm algorithm : { PathAlgorithm::AStar, PathAlgorithm::JumpPoint })
+	{
+		pathfinder.SetAlgorithm(algorithm);
+		pathfinder.FindPaths(queries, batch, &pool);
+		Run(options, results, "FindPaths", (algorithm == PathAlgorithm::AStar) ? "astar" : "jumppoint", [&]() {
+			pathfinder.FindPaths(queries, batch, &pool);
+			return (unsigned long long)batch.Cells.size();
+		});
+	}
+}
+
+static void BenchmarkFlowFields(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	// Builds a field toward the walker start of a generated map and of an open one, then
+	// toggles a small patch next to the start. The update should cost a sliver of a build
+	ThreadPool pool(0);
+	Generator generator("benchmark");
+	generator.SetMapSize(2048, 2048);
+	generator.SetMaxWalkers(64);
+	generator.SetMaxPathLength(options.bQuick ? 20000 : 80000);
+	WorldGrid generated;
+	generator.GenerateMap(generated, std::make_pair(1024, 1024), 12345);
+	BitGrid open(2048, 2048, true);
+
+	FlowField field;
+	for (const BitGrid* layer : { &generated.GetPassableLayer(), (const BitGrid*)&open })
+	{
+		const std::vector<std::pair<int, int>> sources = { std::make_pair((int)layer->RowCount() / 2, (int)layer->ColumnCount() / 2) };
+		Run(options, results, "BuildFlowField", (layer == &open) ? "open" : "generated", [&]() {
+			field.Build(*layer, sources, &pool);
+			return (unsigned long long)layer->RowCount() * layer->ColumnCount();
+		});
+	}
+
+	BitGrid edited = open;
+	const int row = (int)open.RowCount() / 2 + 8;
+	const int column = (int)open.ColumnCount() / 2;
+	Run(options, results, "UpdateFlowField", "patch=4x4", [&]() {
+		for (int x = row; x < row + 4; x++)
+		{
+			for (int y = column; y < column + 4; y++)
+			{
+				edited.Set(x, y, !edited.Get(x, y));
+			}
+		}
+
+		field.Update(edited, std::make_pair(row, row + 4), std::make_pair(column, column + 4), &pool);
+		return 16ULL;
+	});
+}
+
+template<typename Engine>
+static void BenchmarkEngine(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results, const std::string& name)
+{
+	// Bounded rolls like the ones a walker makes every step
+	unsigned int rolls = options.bQuick ? 1000000 : 10000000;
+	Run(options, results, "RandomEngine", name, [&]() {
+		Engine rng = MakeEngine<Engine>(12345, 0);
+		unsigned long long total = 0;
+		for (unsigned int index = 0; index < rolls; index++)
+		{
+			total += UniformRange(rng, 0, 100);
+		}
+
+		// Keeps the loop from being optimized away
+		return (unsigned long long)rolls + (total & 1);
+	});
+}
+
+static void BenchmarkRandomEngines(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	BenchmarkEngine<Xoshiro256>(options, results, "xoshiro256");
+	BenchmarkEngine<Pcg32>(options, results, "pcg32");
+	BenchmarkEngine<CounterEngine>(options, results, "counter");
+	BenchmarkEngine<std::mt19937>(options, results, "mt19937");
+}
+
+static void BenchmarkCellSetLibrary(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+	for (int setCount : { 1, 64 })
+	{
+		std::vector<std::string> names;
+		std::vector<CellSetId> ids;
+		for (int index = 0; index < setCount; index++)
+		{
+			names.push_back("lookup_" + std::to_string(setCount) + "_" + std::to_string(index));
+			ids.push_back(CellSetLibrary::RegisterCellSet(names.back(), Cell(0, true, CellType::Ground)));
+		}
+
+		unsigned int lookups = options.bQuick ? 100000 : 1000000;
+		Run(options, results, "CellSetLibrary", "name,sets=" + std::to_string(setCount), [&]() {
+			unsigned long long found = 0;
+			for (unsigned int index = 0; index < lookups; index++)
+			{
+				found += CellSetLibrary::GetCellSet(names[index % names.size()]) != nullptr;
+			}
+
+			return found;
+		});
+
+		Run(options, results, "CellSetLibrary", "id,sets=" + std::to_string(setCount), [&]() {
+			unsigned long long found = 0;
+			for (unsigned int index = 0; index < lookups; index++)
+			{
+				found += CellSetLibrary::GetCellSet(ids[index % ids.size()]) != nullptr;
+			}
+
+			return found;
+		});
+	}
+}
+
+static void WriteJson(const BenchmarkOptions& options, const std::vector<BenchmarkResult>& results)
+{
+	FILE* file = (options.JsonPath == "-") ? stdout : std::fopen(options.JsonPath.c_str(), "w");
+	if (!file)
+	{
+		std::fprintf(stderr, "Could not open %s\n", options.JsonPath.c_str());
+		return;
+	}
+
+	std::fprintf(file, "{\n  \"repeats\": %u,\n  \"quick\": %s,\n  \"results\": [\n", options.Repeats, options.bQuick ? "true" : "false");
+	for (size_t index = 0; index < results.size(); index++)
+	{
+		const BenchmarkResult& result = results[index];
+		double cellsPerSecond = result.MedianSeconds > 0 ? result.CellsPerIteration / result.MedianSeconds : 0;
+		std::fprintf(file, "    {\"name\": \"%s\", \"group\": \"%s\", \"iterations\": %u, \"median_seconds\": %.9f, \"min_seconds\": %.9f, "
+			"\"cells\": %llu, \"cells_per_second\": %.1f, \"allocations\": %llu, \"allocated_bytes\": %llu, \"peak_rss_kb\": %ld}%s\n",
+			result.Name.c_str(), result.Group.c_str(), result.Iterations, result.MedianSeconds, result.MinSeconds, result.CellsPerIteration,
+			cellsPerSecond, result.AllocationsPerIteration, result.BytesPerIteration, result.PeakRssKB, (index + 1 < results.size()) ? "," : "");
+	}
+
+	std::fprintf(file, "  ]\n}\n");
+	if (file != stdout)
+		std::fclose(file);
+}
+
+static void PrintUsage()
+{
+	std::printf("Usage: WorldGeneratorBenchmark [--quick] [--repeat N] [--filter TEXT] [--json PATH|-]\n");
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	for (int index = 1; index < argc; index++)
+	{
+		std::string argument = argv[index];
+		if (argument == "--quick")
+		{
+			options.bQuick = true;
+		}
+		else if (argument == "--repeat" && index + 1 < argc)
+		{
+			options.Repeats = std::max(1, std::atoi(argv[++index]));
+		}
+		else if (argument == "--filter" && index + 1 < argc)
+		{
+			options.Filter = argv[++index];
+		}
+		else if (argument == "--json" && index + 1 < argc)
+		{
+			options.JsonPath = argv[++index];
+		}
+		else
+		{
+			PrintUsage();
+			return argument == "--help" ? 0 : 1;
+		}
+	}
+
+	CellSetLibrary::CreateCellSet("benchmark", Cell(0, true, CellType::Ground));
+
+	std::vector<BenchmarkResult> results;
+	BenchmarkGenerator(options, results);
+	BenchmarkWalk(options, results);
+	BenchmarkTask(options, results);
+	BenchmarkCache(options, results);
+	BenchmarkMagnification(options, results);
+	BenchmarkLandmarks(options, results);
+	BenchmarkLandmarkPlacement(options, results);
+	BenchmarkInteractableSpawning(options, results);
+	BenchmarkRegions(options, results);
+	BenchmarkPathfinding(options, results);
+	BenchmarkFlowFields(options, results);
+	BenchmarkRandomEngines(options, results);
+	BenchmarkCellSetLibrary(options, results);
+
+	if (!options.JsonPath.empty())
+		WriteJson(options, results);
+
+	CellSetLibrary::RemoveAllSets();
+	return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "WorldGrid.h"
+#include "GenerationStats.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace WorldGenerator
+{
+	// Shared flag for stopping background generation. Copies refer to the same flag, so the
+	// caller keeps one copy and hands another to the generator
+	class CancellationToken
+	{
+	public:
+		CancellationToken() :
+			m_bCancelled(std::make_shared<std::atomic<bool>>(false))
+		{
+		}
+
+		void Cancel()
+		{
+			m_bCancelled->store(true, std::memory_order_relaxed);
+		}
+
+		bool IsCancelled()const
+		{
+			return m_bCancelled->load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::shared_ptr<std::atomic<bool>> m_bCancelled;
+	};
+
+	// Snapshot passed to progress callbacks. Counters are kept whether or not WORLDGEN_STATS is on
+	struct GenerationProgress
+	{
+		unsigned long long WalkerSteps;
+		unsigned long long CellsCarved;
+		// Rough fraction of the work done, from 0 to 1
+		float Fraction;
+	};
+
+	typedef std::function<void(const GenerationProgress&)> ProgressCallback;
+
+	// What a background generation produces
+	struct GenerationResult
+	{
+		GenerationResult() :
+			bSucceeded(false),
+			bCancelled(false),
+			Seed(0)
+		{
+		}
+
+		// False when the settings or start were invalid, or the run was cancelled
+		bool bSucceeded;
+		bool bCancelled;
+		// The seed in use, which is picked from the clock when 0 was passed in
+		unsigned int Seed;
+		WorldGrid Grid;
+		GenerationStats Stats;
+	};
+}
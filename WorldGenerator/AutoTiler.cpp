@@ -0,0 +1,205 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "AutoTiler.h"
+#include "Simd.h"
+#include <algorithm>
+
+namespace WorldGenerator
+{
+	// Table entry for masks that leave the cell as it is
+	static const unsigned char KEEP_CELL = 0xFF;
+
+	// Picks the wall type for a neighbour mask. Sides win over corners, and two
+	// perpendicular sides make the corner between them
+	static unsigned char ClassifyMask(unsigned int mask)
+	{
+		bool bLeft = (mask & AutoTiler::XP) != 0;
+		bool bRight = (mask & AutoTiler::XM) != 0;
+		bool bBottom = (mask & AutoTiler::YP) != 0;
+		bool bTop = (mask & AutoTiler::YM) != 0;
+		bool bHorizontal = bLeft || bRight;
+		bool bVertical = bBottom || bTop;
+
+		CellType type;
+		if (bHorizontal && bVertical)
+		{
+			if (bTop)
+				type = bLeft ? CellType::TLCornerWall : CellType::TRCornerWall;
+			else
+				type = bLeft ? CellType::BLCornerWall : CellType::BRCornerWall;
+		}
+		else if (bHorizontal)
+		{
+			type = bLeft ? CellType::LeftWall : CellType::RightWall;
+		}
+		else if (bVertical)
+		{
+			type = bBottom ? CellType::BottomWall : CellType::TopWall;
+		}
+		else if (mask & AutoTiler::XP_YM)
+		{
+			type = CellType::TLCornerWall;
+		}
+		else if (mask & AutoTiler::XM_YM)
+		{
+			type = CellType::TRCornerWall;
+		}
+		else if (mask & AutoTiler::XP_YP)
+		{
+			type = CellType::BLCornerWall;
+		}
+		else if (mask & AutoTiler::XM_YP)
+		{
+			type = CellType::BRCornerWall;
+		}
+		else
+		{
+			return KEEP_CELL;
+		}
+
+		return (unsigned char)type;
+	}
+
+	struct TileTable
+	{
+		TileTable()
+		{
+			for (unsigned int mask = 0; mask < 256; mask++)
+			{
+				Walls[mask] = ClassifyMask(mask);
+
+				// Cliffs mirror the wall types one block further along CellType
+				unsigned char offset = (unsigned char)CellType::LeftCliff - (unsigned char)CellType::LeftWall;
+				Cliffs[mask] = (Walls[mask] == KEEP_CELL) ? KEEP_CELL : (unsigned char)(Walls[mask] + offset);
+			}
+		}
+
+		unsigned char Walls[256];
+		unsigned char Cliffs[256];
+	};
+
+	static const TileTable& GetTileTable()
+	{
+		static const TileTable table;
+		return table;
+	}
+
+	// Writes 0xFF for every ground cell of row x in [first - 1, last] and 0 elsewhere, including off-grid cells
+	static void LoadGroundMask(const PaletteGrid& grid, int x, int first, int last, unsigned char* mask)
+	{
+		const int width = last - first + 2;
+		std::fill_n(mask, width, (unsigned char)0);
+		if (x < 0 || x >= (int)grid.RowCount())
+			return;
+
+		// Only the part of the span that is on the grid can hold ground
+		const int offset = first - 1;
+		const int begin = std::max(offset, 0);
+		const int end = std::min(last + 1, (int)grid.ColumnCount());
+		const unsigned char ground = CellSet::GetPaletteIndex(CellType::Ground);
+		const unsigned char* row = grid[x].data();
+
+		int y = begin;
+#ifdef WORLDGEN_SSE2
+		const __m128i groundVector = _mm_set1_epi8((char)ground);
+		for (; y + 16 <= end; y += 16)
+		{
+			__m128i cells = _mm_loadu_si128((const __m128i*)(row + y));
+			_mm_storeu_si128((__m128i*)(mask + y - offset), _mm_cmpeq_epi8(cells, groundVector));
+		}
+#endif
+		for (; y < end; y++)
+		{
+			mask[y - offset] = (row[y] == ground) ? 0xFF : 0;
+		}
+	}
+
+	void AutoTiler::Apply(PaletteGrid& grid, int elevation)
+	{
+		Apply(grid, std::make_pair(0, (int)grid.RowCount()), std::make_pair(0, (int)grid.ColumnCount()), elevation);
+	}
+
+	void AutoTiler::Apply(PaletteGrid& grid, std::pair<int, int> rowRange, std::pair<int, int> columnRange, int elevation)
+	{
+		rowRange.first = std::max(rowRange.first, 0);
+		rowRange.second = std::min(rowRange.second, (int)grid.RowCount());
+		columnRange.first = std::max(columnRange.first, 0);
+		columnRange.second = std::min(columnRange.second, (int)grid.ColumnCount());
+		if (rowRange.first >= rowRange.second || columnRange.first >= columnRange.second)
+			return;
+
+		const unsigned char* table = (elevation > 0) ? GetTileTable().Cliffs : GetTileTable().Walls;
+		const int width = columnRange.second - columnRange.first;
+
+		// Ground masks of the rows above, at and below the current row, padded by a
+		// cell on each side plus room for a full vector past the end
+		const int stride = width + 2 + 16;
+		std::vector<unsigned char> buffer((size_t)stride * 3, 0);
+		unsigned char* above = buffer.data();
+		unsigned char* middle = above + stride;
+		unsigned char* below = middle + stride;
+		LoadGroundMask(grid, rowRange.first - 1, columnRange.first, columnRange.second, above);
+		LoadGroundMask(grid, rowRange.first, columnRange.first, columnRange.second, middle);
+
+		for (int x = rowRange.first; x < rowRange.second; x++)
+		{
+			LoadGroundMask(grid, x + 1, columnRange.first, columnRange.second, below);
+			unsigned char* row = grid[x].data() + columnRange.first;
+
+			int index = 0;
+#ifdef WORLDGEN_SSE2
+			const __m128i zero = _mm_setzero_si128();
+			for (; index + 16 <= width; index += 16)
+			{
+				// Gather all eight neighbour bits for 16 cells at once
+				__m128i mask = _mm_and_si128(_mm_loadu_si128((const __m128i*)(above + index)), _mm_set1_epi8((char)XM_YM));
+				mask = _mm_or_si128(mask, _mm_and_si128(_mm_loadu_si128((const __m128i*)(above + index + 1)), _mm_set1_epi8((char)XM)));
+				mask = _mm_or_si128(mask, _mm_and_si128(_mm_loadu_si128((const __m128i*)(above + index + 2)), _mm_set1_epi8((char)XM_YP)));
+				mask = _mm_or_si128(mask, _mm_and_si128(_mm_loadu_si128((const __m128i*)(middle + index)), _mm_set1_epi8((char)YM)));
+				mask = _mm_or_si128(mask, _mm_and_si128(_mm_loadu_si128((const __m128i*)(middle + index + 2)), _mm_set1_epi8((char)YP)));
+				mask = _mm_or_si128(mask, _mm_and_si128(_mm_loadu_si128((const __m128i*)(below + index)), _mm_set1_epi8((char)XP_YM)));
+				mask = _mm_or_si128(mask, _mm_and_si128(_mm_loadu_si128((const __m128i*)(below + index + 1)), _mm_set1_epi8((char)XP)));
+				mask = _mm_or_si128(mask, _mm_and_si128(_mm_loadu_si128((const __m128i*)(below + index + 2)), _mm_set1_epi8((char)XP_YP)));
+
+				// Only non-ground cells with ground around them change
+				__m128i skip = _mm_or_si128(_mm_cmpeq_epi8(mask, zero), _mm_loadu_si128((const __m128i*)(middle + index + 1)));
+				int active = ~_mm_movemask_epi8(skip) & 0xFFFF;
+				if (!active)
+					continue;
+
+				unsigned char masks[16];
+				_mm_storeu_si128((__m128i*)masks, mask);
+				for (int lane = 0; lane < 16; lane++)
+				{
+					if (active & (1 << lane))
+						row[index + lane] = table[masks[lane]];
+				}
+			}
+#endif
+			for (; index < width; index++)
+			{
+				if (middle[index + 1])
+					continue;
+
+				unsigned int mask = (above[index] & XM_YM) | (above[index + 1] & XM) | (above[index + 2] & XM_YP) |
+					(middle[index] & YM) | (middle[index + 2] & YP) |
+					(below[index] & XP_YM) | (below[index + 1] & XP) | (below[index + 2] & XP_YP);
+
+				if (mask)
+					row[index] = table[mask];
+			}
+
+			// Rotate the row masks down by one
+			unsigned char* oldAbove = above;
+			above = middle;
+			middle = below;
+			below = oldAbove;
+		}
+	}
+
+	CellType AutoTiler::GetTileType(unsigned char neighbourMask, int elevation)
+	{
+		unsigned char type = (elevation > 0) ? GetTileTable().Cliffs[neighbourMask] : GetTileTable().Walls[neighbourMask];
+		return (type == KEEP_CELL) ? CellType::Empty : (CellType)type;
+	}
+}
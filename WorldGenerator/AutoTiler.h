@@ -0,0 +1,37 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "PaletteGrid.h"
+
+namespace WorldGenerator
+{
+	// Turns the non-ground cells bordering ground into wall or cliff cells.
+	// Each cell gets an 8 bit mask of which neighbours are ground, which is mapped
+	// through a lookup table to the matching side or corner type.
+	class AutoTiler
+	{
+	public:
+		// Neighbour bits, named by their offset from the cell along x (rows) and y (columns)
+		enum NeighbourBit
+		{
+			XM_YM = 1 << 0,
+			XM = 1 << 1,
+			XM_YP = 1 << 2,
+			YM = 1 << 3,
+			YP = 1 << 4,
+			XP_YM = 1 << 5,
+			XP = 1 << 6,
+			XP_YP = 1 << 7,
+		};
+
+		// Tiles the whole grid. Ground at elevation 0 is bordered by walls, higher ground by cliffs
+		static void Apply(PaletteGrid& grid, int elevation);
+
+		// Tiles the cells in [rowRange.first, rowRange.second) x [columnRange.first, columnRange.second).
+		// Neighbours outside the range are still read when they are on the grid
+		static void Apply(PaletteGrid& grid, std::pair<int, int> rowRange, std::pair<int, int> columnRange, int elevation);
+
+		// Gets the border type for a neighbour mask. Returns Empty when no neighbour is ground
+		static CellType GetTileType(unsigned char neighbourMask, int elevation);
+	};
+}
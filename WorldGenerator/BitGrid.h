@@ -0,0 +1,217 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace WorldGenerator
+{
+	// One bit per cell, row-major. Every row starts on a fresh 64 bit word and the bits past
+	// the last column are kept clear, so whole words can be tested and counted directly.
+	class BitGrid
+	{
+	public:
+		static const unsigned int WORD_BITS = 64;
+
+		BitGrid()
+		{
+			m_Rows = 0;
+			m_Columns = 0;
+			m_WordsPerRow = 0;
+		}
+
+		BitGrid(int rows, int columns, bool value = false)
+		{
+			assign(rows, columns, value);
+		}
+
+		unsigned int RowCount()const
+		{
+			return m_Rows;
+		}
+
+		unsigned int ColumnCount()const
+		{
+			return m_Columns;
+		}
+
+		// Number of words that hold a row, including the partly used last one
+		unsigned int WordsPerRow()const
+		{
+			return m_WordsPerRow;
+		}
+
+		// Discards the current contents and sets every bit to value
+		void assign(int rows, int columns, bool value = false)
+		{
+			m_Rows = std::max(rows, 0);
+			m_Columns = std::max(columns, 0);
+			m_WordsPerRow = (m_Columns + WORD_BITS - 1) / WORD_BITS;
+			m_Words.assign((size_t)m_Rows * m_WordsPerRow, value ? ~0ULL : 0ULL);
+			if (value)
+			{
+				for (unsigned int x = 0; x < m_Rows; x++)
+				{
+					ClearPadding(x);
+				}
+			}
+		}
+
+		void clear()
+		{
+			m_Rows = 0;
+			m_Columns = 0;
+			m_WordsPerRow = 0;
+			m_Words.clear();
+		}
+
+		bool Get(int x, int y)const
+		{
+			return (m_Words[(size_t)x * m_WordsPerRow + y / WORD_BITS] >> (y % WORD_BITS)) & 1;
+		}
+
+		void Set(int x, int y, bool value)
+		{
+			unsigned long long& word = m_Words[(size_t)x * m_WordsPerRow + y / WORD_BITS];
+			unsigned long long bit = 1ULL << (y % WORD_BITS);
+			word = value ? (word | bit) : (word & ~bit);
+		}
+
+		bool at(int x, int y)const
+		{
+			if (x < 0 || (unsigned int)x >= m_Rows || y < 0 || (unsigned int)y >= m_Columns)
+				throw std::out_of_range("BitGrid::at");
+
+			return Get(x, y);
+		}
+
+		// Words of row x. Bit b of word w is column w * 64 + b
+		unsigned long long* RowWords(int x)
+		{
+			return m_Words.data() + (size_t)x * m_WordsPerRow;
+		}
+
+		const unsigned long long* RowWords(int x)const
+		{
+			return m_Words.data() + (size_t)x * m_WordsPerRow;
+		}
+
+		// Counts the set bits of row x in columns [first, last)
+		size_t CountRow(int x, int first, int last)const
+		{
+			first = std::max(first, 0);
+			last = std::min(last, (int)m_Columns);
+			if (first >= last)
+				return 0;
+
+			const unsigned long long* words = RowWords(x);
+			int firstWord = first / WORD_BITS;
+			int lastWord = (last - 1) / WORD_BITS;
+			unsigned long long firstMask = ~0ULL << (first % WORD_BITS);
+			unsigned long long lastMask = ~0ULL >> (WORD_BITS - 1 - (last - 1) % WORD_BITS);
+
+			if (firstWord == lastWord)
+				return PopCount(words[firstWord] & firstMask & lastMask);
+
+			size_t count = PopCount(words[firstWord] & firstMask) + PopCount(words[lastWord] & lastMask);
+			for (int word = firstWord + 1; word < lastWord; word++)
+			{
+				count += PopCount(words[word]);
+			}
+
+			return count;
+		}
+
+		// Counts the set bits in [rowRange.first, rowRange.second) x [columnRange.first, columnRange.second)
+		size_t Count(std::pair<int, int> rowRange, std::pair<int, int> columnRange)const
+		{
+			rowRange.first = std::max(rowRange.first, 0);
+			rowRange.second = std::min(rowRange.second, (int)m_Rows);
+
+			size_t count = 0;
+			for (int x = rowRange.first; x < rowRange.second; x++)
+			{
+				count += CountRow(x, columnRange.first, columnRange.second);
+			}
+
+			return count;
+		}
+
+		// Counts every set bit. Padding bits are always clear, so this is a straight sweep
+		size_t Count()const
+		{
+			size_t count = 0;
+			for (unsigned long long word : m_Words)
+			{
+				count += PopCount(word);
+			}
+
+			return count;
+		}
+
+		static unsigned int PopCount(unsigned long long word)
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			return (unsigned int)__popcnt64(word);
+#elif defined(__GNUC__)
+			return (unsigned int)__builtin_popcountll(word);
+#else
+			word = word - ((word >> 1) & 0x5555555555555555ULL);
+			word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+			word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+			return (unsigned int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+		}
+
+		// Index of the lowest set bit. word must not be 0
+		static unsigned int CountTrailingZeros(unsigned long long word)
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			unsigned long index;
+			_BitScanForward64(&index, word);
+			return (unsigned int)index;
+#elif defined(__GNUC__)
+			return (unsigned int)__builtin_ctzll(word);
+#else
+			return PopCount((word & (0 - word)) - 1);
+#endif
+		}
+
+		// Index of the highest set bit. word must not be 0
+		static unsigned int HighestBit(unsigned long long word)
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			unsigned long index;
+			_BitScanReverse64(&index, word);
+			return (unsigned int)index;
+#elif defined(__GNUC__)
+			return (unsigned int)(63 - __builtin_clzll(word));
+#else
+			unsigned int index = 0;
+			while (word >>= 1)
+			{
+				index++;
+			}
+
+			return index;
+#endif
+		}
+
+	private:
+		void ClearPadding(unsigned int x)
+		{
+			unsigned int used = m_Columns % WORD_BITS;
+			if (used != 0)
+				m_Words[(size_t)x * m_WordsPerRow + m_WordsPerRow - 1] &= ~0ULL >> (WORD_BITS - used);
+		}
+
+		unsigned int m_Rows;
+		unsigned int m_Columns;
+		unsigned int m_WordsPerRow;
+		std::vector<unsigned long long> m_Words;
+	};
+}
@@ -8,7 +8,7 @@
 namespace WorldGenerator
 {
 	// Defines the type of cells that the Cell struct can represent
-	enum class CellType
+	enum class CellType : unsigned char
 	{
 		Ground = 0,
 		LeftWall,
@@ -34,7 +34,7 @@ namespace WorldGenerator
 		Empty,
 	};
 
-	// Basic struct to hold cell information
+	// Basic struct to hold cell information, packed into 4 bytes
 	struct Cell
 	{
 		Cell()
@@ -46,23 +46,29 @@ namespace WorldGenerator
 
 		Cell(int depth, bool passable, CellType type)
 		{
-			Depth = depth;
+			Depth = (short)depth;
 			Passable = passable;
 			Type = type;
 		}
 
-		int Depth;
+		short Depth;
 		bool Passable;
 		CellType Type;
 	};
 
+	static_assert(sizeof(Cell) <= 4, "Cell is expected to pack into 4 bytes");
+
 	class CellSet
 	{
 	public:
+		// Number of palette entries, one per CellType including Empty
+		static const unsigned int PALETTE_SIZE = (unsigned int)CellType::Empty + 1;
+
 		CellSet(Cell defaultCell)
 		{
 			m_DefaultCell = defaultCell;
 			GenerateGenericSet();
+			BuildPalette();
 		}
 
 		CellSet(Cell defaultCell, std::vector<Cell> cells)
@@ -74,19 +80,21 @@ namespace WorldGenerator
 		void SetDefaultCell(Cell defaultCell)
 		{
 			m_DefaultCell = defaultCell;
+			BuildPalette();
 		}
 
 		void SetCellArray(std::vector<Cell>& arr)
 		{
 			m_Cells = arr;
+			BuildPalette();
 		}
 
-		Cell GetDefaultCell()
+		Cell GetDefaultCell()const
 		{
 			return m_DefaultCell;
 		}
 
-		Cell GetCell(CellType type)
+		Cell GetCell(CellType type)const
 		{
 			if(m_Cells.size() > (unsigned int)type)
 				return m_Cells[(unsigned int)type];
@@ -94,6 +102,18 @@ namespace WorldGenerator
 			return m_DefaultCell;
 		}
 
+		// Palette index stored by grids for the given type
+		static unsigned char GetPaletteIndex(CellType type)
+		{
+			return (unsigned char)type;
+		}
+
+		// Decoded cells indexed by palette index. The Empty entry decodes to an unset Cell
+		const Cell* GetPalette()const
+		{
+			return m_Palette;
+		}
+
 	private:
 		void GenerateGenericSet()
 		{
@@ -117,42 +137,18 @@ namespace WorldGenerator
 			}
 		}
 
-		Cell m_DefaultCell;
-		std::vector<Cell> m_Cells;
-	};
-
-	class WorldGrid
-	{
-	public:
-		unsigned int RowCount()const
+		void BuildPalette()
 		{
-			return (unsigned int)m_Grid.size();
-		}
-
-		unsigned int ColumnCount()const
-		{
-			if (m_Grid.size() > 0)
-				return (unsigned int)m_Grid[0].size();
-
-			return 0;
-		}
-
-		void resize(int count)
-		{
-			m_Grid.resize(count);
-		}
-
-		std::vector<Cell>& at(int x)
-		{
-			return m_Grid[x];
-		}
+			for (unsigned int index = 0; index < PALETTE_SIZE; index++)
+			{
+				m_Palette[index] = GetCell((CellType)index);
+			}
 
-		std::vector<Cell>& operator[](int x)
-		{
-			return m_Grid[x];
+			m_Palette[(unsigned int)CellType::Empty] = Cell();
 		}
 
-	private:
-		std::vector<std::vector<Cell>> m_Grid;
+		Cell m_DefaultCell;
+		std::vector<Cell> m_Cells;
+		Cell m_Palette[PALETTE_SIZE];
 	};
 }
\ No newline at end of file
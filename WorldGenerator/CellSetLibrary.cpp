@@ -1,64 +1,161 @@
 // Created by Eric Marquez. All rights reserved
 
 #include "CellSetLibrary.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace WorldGenerator
 {
-	std::map<std::string, CellSet*> CellSetLibrary::m_CellSets = std::map<std::string, CellSet*>();
-
-	CellSetLibrary::~CellSetLibrary()
+	// Id indexed array of sets. Tables only grow: a full table is copied into one twice its
+	// size and kept until RemoveAllSets, so readers holding the old one stay safe
+	struct CellSetTable
 	{
-		RemoveAllSets();
-	}
+		explicit CellSetTable(unsigned int capacity) :
+			Capacity(capacity),
+			Sets(new const CellSet*[capacity]())
+		{
+		}
 
+		unsigned int Capacity;
+		std::unique_ptr<const CellSet*[]> Sets;
+	};
 
-	CellSet* CellSetLibrary::GetCellSet(std::string uniqueName)
+	struct CellSetRegistry
 	{
-		// Found
-		if (m_CellSets.find(uniqueName) != m_CellSets.end())
+		CellSetRegistry() :
+			Table(nullptr),
+			Count(0)
 		{
-			return m_CellSets[uniqueName];
 		}
 
-		return nullptr;
+		// Read without locking. Slots are filled before Count is raised past them
+		std::atomic<const CellSetTable*> Table;
+		std::atomic<unsigned int> Count;
+
+		// Everything below is only touched while holding WriteMutex
+		std::mutex WriteMutex;
+		std::unordered_map<std::string, CellSetId> Ids;
+		std::vector<std::string> Names;
+		std::vector<std::unique_ptr<const CellSet>> Sets;
+		std::vector<std::unique_ptr<CellSetTable>> Tables;
+	};
+
+	static const unsigned int INITIAL_TABLE_CAPACITY = 16;
+
+	static CellSetRegistry& GetRegistry()
+	{
+		static CellSetRegistry registry;
+		return registry;
+	}
+
+	CellSetLibrary::~CellSetLibrary()
+	{
+		RemoveAllSets();
+	}
+
+	CellSetId CellSetLibrary::RegisterCellSet(const std::string& uniqueName, Cell defaultCell)
+	{
+		return Publish(uniqueName, new CellSet(defaultCell));
 	}
 
+	CellSetId CellSetLibrary::RegisterCellSet(const std::string& uniqueName, Cell defaultCell, const std::vector<Cell>& cells)
+	{
+		return Publish(uniqueName, new CellSet(defaultCell, cells));
+	}
 
 	bool CellSetLibrary::CreateCellSet(std::string uniqueName, Cell defaultCell)
 	{
-		// Found
-		if (m_CellSets.find(uniqueName) != m_CellSets.end())
-		{
-			return false;
-		}
+		return RegisterCellSet(uniqueName, defaultCell) != INVALID_CELL_SET_ID;
+	}
+
+	bool CellSetLibrary::CreateCellSet(std::string uniqueName, Cell defaultCell, std::vector<Cell> cells)
+	{
+		return RegisterCellSet(uniqueName, defaultCell, cells) != INVALID_CELL_SET_ID;
+	}
 
-		m_CellSets[uniqueName] = new CellSet(defaultCell);
+	const CellSet* CellSetLibrary::GetCellSet(CellSetId id)
+	{
+		CellSetRegistry& registry = GetRegistry();
+		if (id >= registry.Count.load(std::memory_order_acquire))
+			return nullptr;
 
-		return true;
+		// Any table published by the time the count was raised holds the slot
+		return registry.Table.load(std::memory_order_acquire)->Sets[id];
 	}
 
+	const CellSet* CellSetLibrary::GetCellSet(const std::string& uniqueName)
+	{
+		return GetCellSet(GetCellSetId(uniqueName));
+	}
 
-	bool CellSetLibrary::CreateCellSet(std::string uniqueName, Cell defaultCell, std::vector<Cell> cells)
+	CellSetId CellSetLibrary::GetCellSetId(const std::string& uniqueName)
 	{
-		// Found
-		if (m_CellSets.find(uniqueName) != m_CellSets.end())
-		{
-			return false;
-		}
+		CellSetRegistry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.WriteMutex);
 
-		m_CellSets[uniqueName] = new CellSet(defaultCell, cells);
+		auto found = registry.Ids.find(uniqueName);
+		return (found != registry.Ids.end()) ? found->second : INVALID_CELL_SET_ID;
+	}
+
+	std::string CellSetLibrary::GetCellSetName(CellSetId id)
+	{
+		CellSetRegistry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.WriteMutex);
 
-		return true;
+		return (id < registry.Names.size()) ? registry.Names[id] : std::string();
 	}
 
+	unsigned int CellSetLibrary::GetCellSetCount()
+	{
+		return GetRegistry().Count.load(std::memory_order_acquire);
+	}
 
 	void CellSetLibrary::RemoveAllSets()
 	{
-		for (auto& set : m_CellSets)
+		CellSetRegistry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.WriteMutex);
+
+		registry.Count.store(0, std::memory_order_release);
+		registry.Table.store(nullptr, std::memory_order_release);
+		registry.Ids.clear();
+		registry.Names.clear();
+		registry.Sets.clear();
+		registry.Tables.clear();
+	}
+
+	CellSetId CellSetLibrary::Publish(const std::string& uniqueName, CellSet* cellSet)
+	{
+		std::unique_ptr<const CellSet> owned(cellSet);
+		CellSetRegistry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.WriteMutex);
+
+		// Found
+		if (registry.Ids.find(uniqueName) != registry.Ids.end())
+			return INVALID_CELL_SET_ID;
+
+		const CellSetId id = (CellSetId)registry.Sets.size();
+		CellSetTable* table = registry.Tables.empty() ? nullptr : registry.Tables.back().get();
+		if (!table || id == table->Capacity)
 		{
-			delete set.second;
+			std::unique_ptr<CellSetTable> grown(new CellSetTable(table ? table->Capacity * 2 : INITIAL_TABLE_CAPACITY));
+			for (CellSetId index = 0; index < id; index++)
+			{
+				grown->Sets[index] = table->Sets[index];
+			}
+
+			table = grown.get();
+			registry.Tables.push_back(std::move(grown));
+			registry.Table.store(table, std::memory_order_release);
 		}
 
-		m_CellSets.clear();
+		table->Sets[id] = owned.get();
+		registry.Ids[uniqueName] = id;
+		registry.Names.push_back(uniqueName);
+		registry.Sets.push_back(std::move(owned));
+		registry.Count.store(id + 1, std::memory_order_release);
+
+		return id;
 	}
 }
@@ -2,25 +2,52 @@
 // Created by Eric Marquez. All rights reserved
 
 #include "Cell.h"
+#include <string>
 
 namespace WorldGenerator
 {
+	// Handle of a registered cell set. Ids are handed out in registration order starting at 0
+	typedef unsigned int CellSetId;
+
+	static const CellSetId INVALID_CELL_SET_ID = 0xFFFFFFFFu;
+
+	// Registry of named cell sets. Sets are immutable once registered and live until
+	// RemoveAllSets. Looking a set up by id is lock-free, so generator threads can resolve
+	// sets on hot paths without contending. Names are interned once at registration and
+	// looked up under a lock.
 	class CellSetLibrary
 	{
 	public:
 
 		~CellSetLibrary();
 
-		static CellSet* GetCellSet(std::string uniqueName);
+		// Registers a new set and returns its id, or INVALID_CELL_SET_ID when the name is taken
+		static CellSetId RegisterCellSet(const std::string& uniqueName, Cell defaultCell);
 
+		static CellSetId RegisterCellSet(const std::string& uniqueName, Cell defaultCell, const std::vector<Cell>& cells);
+
+		// Same as RegisterCellSet, returning whether the set was added
 		static bool CreateCellSet(std::string uniqueName, Cell defaultCell);
 
 		static bool CreateCellSet(std::string uniqueName, Cell defaultCell, std::vector<Cell> cells);
 
+		// Returns nullptr for ids that were never handed out
+		static const CellSet* GetCellSet(CellSetId id);
+
+		static const CellSet* GetCellSet(const std::string& uniqueName);
+
+		static CellSetId GetCellSetId(const std::string& uniqueName);
+
+		// Returns an empty name for ids that were never handed out
+		static std::string GetCellSetName(CellSetId id);
+
+		static unsigned int GetCellSetCount();
+
+		// Frees every set and starts ids from 0 again. Nothing may be using a set, or looking one up, while this runs
 		static void RemoveAllSets();
 
 	private:
 
-		static std::map<std::string, CellSet*> m_CellSets;
+		static CellSetId Publish(const std::string& uniqueName, CellSet* cellSet);
 	};
 }
@@ -0,0 +1,264 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "ChunkedWorld.h"
+#include "Random.h"
+#include <algorithm>
+
+namespace WorldGenerator
+{
+	static long long FloorDivide(long long value, long long divisor)
+	{
+		return (value >= 0) ? value / divisor : -((-value - 1) / divisor) - 1;
+	}
+
+	ChunkedWorld::ChunkedWorld(const Generator& generator, unsigned int seed) :
+		m_Generator(generator)
+	{
+		// Walks may reach one chunk past the chunk that seeds them
+		m_Generator.SetMapSize(CHUNK_SIZE * 3, CHUNK_SIZE * 3);
+		m_Generator.SetMagnification(1, 1);
+		m_Seed = seed;
+		m_CaveDensity = 50;
+		m_MemoryBudget = 64 * 1024 * 1024;
+	}
+
+	void ChunkedWorld::SetCaveDensityPercent(int percent)
+	{
+		m_CaveDensity = std::max(0, std::min(percent, 100));
+	}
+
+	void ChunkedWorld::SetMemoryBudget(size_t bytes)
+	{
+		m_MemoryBudget = bytes;
+		EvictOverBudget(0);
+	}
+
+	void ChunkedWorld::RequestWindow(long long row, long long column, int rows, int columns)
+	{
+		if (rows <= 0 || columns <= 0)
+			return;
+
+		ChunkCoord first = GetChunkCoord(row, column);
+		ChunkCoord last = GetChunkCoord(row + rows - 1, column + columns - 1);
+		LoadChunks(first, last);
+
+		// Keep the window at the front of the eviction order
+		size_t pinned = 0;
+		for (int x = first.Row; x <= last.Row; x++)
+		{
+			for (int y = first.Column; y <= last.Column; y++)
+			{
+				Touch(m_Chunks[GetKey(ChunkCoord(x, y))]);
+				pinned++;
+			}
+		}
+
+		EvictOverBudget(pinned);
+	}
+
+	void ChunkedWorld::CopyWindow(WorldGrid& grid, long long row, long long column, int rows, int columns)
+	{
+		PaletteGrid window;
+		CopyWindow(window, row, column, rows, columns);
+		window.Decode(grid);
+	}
+
+	void ChunkedWorld::CopyWindow(PaletteGrid& grid, long long row, long long column, int rows, int columns)
+	{
+		grid.SetCellSet(m_Generator.GetCellSet());
+		grid.assign(rows, columns);
+		if (rows <= 0 || columns <= 0)
+			return;
+
+		RequestWindow(row, column, rows, columns);
+
+		// Copy chunk sized runs of each row
+		for (int x = 0; x < rows; x++)
+		{
+			long long worldRow = row + x;
+			int chunkRow = (int)FloorDivide(worldRow, CHUNK_SIZE);
+			int localRow = (int)(worldRow - (long long)chunkRow * CHUNK_SIZE);
+
+			int y = 0;
+			while (y < columns)
+			{
+				long long worldColumn = column + y;
+				int chunkColumn = (int)FloorDivide(worldColumn, CHUNK_SIZE);
+				int localColumn = (int)(worldColumn - (long long)chunkColumn * CHUNK_SIZE);
+				int count = std::min(CHUNK_SIZE - localColumn, columns - y);
+
+				const PaletteGrid& chunk = m_Chunks[GetKey(ChunkCoord(chunkRow, chunkColumn))].Cells;
+				std::copy_n(chunk[localRow].data() + localColumn, count, grid[x].data() + y);
+				y += count;
+			}
+		}
+	}
+
+	Cell ChunkedWorld::GetCell(long long row, long long column)
+	{
+		ChunkCoord coord = GetChunkCoord(row, column);
+		const PaletteGrid& chunk = GetChunk(coord);
+		return chunk.GetCell((int)(row - (long long)coord.Row * CHUNK_SIZE), (int)(column - (long long)coord.Column * CHUNK_SIZE));
+	}
+
+	const PaletteGrid& ChunkedWorld::GetChunk(ChunkCoord coord)
+	{
+		auto found = m_Chunks.find(GetKey(coord));
+		if (found != m_Chunks.end())
+		{
+			Touch(found->second);
+			return found->second.Cells;
+		}
+
+		LoadChunks(coord, coord);
+		EvictOverBudget(1);
+		return m_Chunks[GetKey(coord)].Cells;
+	}
+
+	void ChunkedWorld::Clear()
+	{
+		m_Chunks.clear();
+		m_RecentChunks.clear();
+	}
+
+	bool ChunkedWorld::IsChunkLoaded(ChunkCoord coord) const
+	{
+		return m_Chunks.find(GetKey(coord)) != m_Chunks.end();
+	}
+
+	size_t ChunkedWorld::GetLoadedChunkCount() const
+	{
+		return m_Chunks.size();
+	}
+
+	size_t ChunkedWorld::GetMemoryUsage() const
+	{
+		return m_Chunks.size() * GetChunkBytes();
+	}
+
+	size_t ChunkedWorld::GetMemoryBudget() const
+	{
+		return m_MemoryBudget;
+	}
+
+	int ChunkedWorld::GetCaveDensityPercent() const
+	{
+		return m_CaveDensity;
+	}
+
+	unsigned int ChunkedWorld::GetSeed() const
+	{
+		return m_Seed;
+	}
+
+	ChunkCoord ChunkedWorld::GetChunkCoord(long long row, long long column)
+	{
+		return ChunkCoord((int)FloorDivide(row, CHUNK_SIZE), (int)FloorDivide(column, CHUNK_SIZE));
+	}
+
+	void ChunkedWorld::LoadChunks(ChunkCoord first, ChunkCoord last)
+	{
+		// Find the chunks that still need generating
+		std::vector<ChunkCoord> missing;
+		for (int x = first.Row; x <= last.Row; x++)
+		{
+			for (int y = first.Column; y <= last.Column; y++)
+			{
+				if (!IsChunkLoaded(ChunkCoord(x, y)))
+					missing.emplace_back(x, y);
+			}
+		}
+
+		if (missing.empty())
+			return;
+
+		const unsigned char ground = CellSet::GetPaletteIndex(CellType::Ground);
+		for (const auto& coord : missing)
+		{
+			Chunk& chunk = m_Chunks[GetKey(coord)];
+			chunk.Cells = PaletteGrid(m_Generator.GetCellSet(), CHUNK_SIZE, CHUNK_SIZE);
+			m_RecentChunks.push_front(GetKey(coord));
+			chunk.Recent = m_RecentChunks.begin();
+		}
+
+		// Walk every origin that can reach a missing chunk once, then stamp it into each of them
+		PaletteGrid canvas;
+		for (int x = first.Row - 1; x <= last.Row + 1; x++)
+		{
+			for (int y = first.Column - 1; y <= last.Column + 1; y++)
+			{
+				bool bCarved = false;
+				CarveOrigin(ChunkCoord(x, y), canvas, bCarved);
+				if (!bCarved)
+					continue;
+
+				for (const auto& coord : missing)
+				{
+					int rowOffset = coord.Row - x + 1;
+					int columnOffset = coord.Column - y + 1;
+					if (rowOffset < 0 || rowOffset > 2 || columnOffset < 0 || columnOffset > 2)
+						continue;
+
+					PaletteGrid& cells = m_Chunks[GetKey(coord)].Cells;
+					for (int row = 0; row < CHUNK_SIZE; row++)
+					{
+						const unsigned char* source = canvas[rowOffset * CHUNK_SIZE + row].data() + columnOffset * CHUNK_SIZE;
+						unsigned char* dest = cells[row].data();
+						for (int column = 0; column < CHUNK_SIZE; column++)
+						{
+							if (source[column] == ground)
+								dest[column] = ground;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void ChunkedWorld::CarveOrigin(ChunkCoord origin, PaletteGrid& canvas, bool& bCarved)
+	{
+		unsigned long long hash = DeriveSeed(m_Seed, GetKey(origin));
+		bCarved = false;
+
+		if ((int)(hash % 100) >= m_CaveDensity)
+			return;
+
+		// Start somewhere inside the origin chunk, which sits in the middle of the canvas
+		unsigned long long roll = MixSeed(hash);
+		std::pair<int, int> start;
+		start.first = CHUNK_SIZE + (int)(roll % CHUNK_SIZE);
+		start.second = CHUNK_SIZE + (int)((roll >> 32) % CHUNK_SIZE);
+
+		// A zero seed would fall back to the clock
+		unsigned int seed = (unsigned int)(hash >> 32);
+		seed = seed ? seed : 1;
+
+		std::pair<int, int> rowRange;
+		std::pair<int, int> columnRange;
+		bCarved = m_Generator.CarveMap(canvas, start, seed, rowRange, columnRange);
+	}
+
+	void ChunkedWorld::Touch(Chunk& chunk)
+	{
+		m_RecentChunks.splice(m_RecentChunks.begin(), m_RecentChunks, chunk.Recent);
+	}
+
+	void ChunkedWorld::EvictOverBudget(size_t pinnedCount)
+	{
+		while (GetMemoryUsage() > m_MemoryBudget && m_RecentChunks.size() > pinnedCount)
+		{
+			m_Chunks.erase(m_RecentChunks.back());
+			m_RecentChunks.pop_back();
+		}
+	}
+
+	size_t ChunkedWorld::GetChunkBytes() const
+	{
+		return (size_t)CHUNK_SIZE * CHUNK_SIZE + sizeof(Chunk) + sizeof(unsigned long long) * 4;
+	}
+
+	unsigned long long ChunkedWorld::GetKey(ChunkCoord coord)
+	{
+		return ((unsigned long long)(unsigned int)coord.Row << 32) | (unsigned int)coord.Column;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "Generator.h"
+#include <list>
+#include <unordered_map>
+
+namespace WorldGenerator
+{
+	// Position of a chunk measured in whole chunks
+	struct ChunkCoord
+	{
+		ChunkCoord()
+		{
+			Row = 0;
+			Column = 0;
+		}
+
+		ChunkCoord(int row, int column)
+		{
+			Row = row;
+			Column = column;
+		}
+
+		int Row;
+		int Column;
+	};
+
+	// Unbounded world split into fixed size chunks that are generated on demand.
+	// Every chunk may seed one drunken walk that is free to wander through the 8 chunks
+	// around it, so a chunk's content is the union of the walks seeded in its neighbourhood.
+	// Walk seeds only depend on the world seed and the chunk coordinate, which keeps any
+	// chunk reproducible after it has been evicted.
+	class ChunkedWorld
+	{
+	public:
+		// Cells per chunk side
+		static const int CHUNK_SIZE = 64;
+
+		// Uses the cell set and walker settings of generator. Map size and magnification are ignored
+		ChunkedWorld(const Generator& generator, unsigned int seed);
+
+		// Sets the chance that a chunk seeds a walk of its own
+		void SetCaveDensityPercent(int percent);
+
+		// Sets the most memory loaded chunks may use before the least recently used are evicted
+		void SetMemoryBudget(size_t bytes);
+
+		// Makes sure every chunk overlapping the window is loaded
+		void RequestWindow(long long row, long long column, int rows, int columns);
+
+		// Copies a window of the world into grid, generating chunks as needed
+		void CopyWindow(WorldGrid& grid, long long row, long long column, int rows, int columns);
+
+		// Copies a window of the world as palette indices, generating chunks as needed
+		void CopyWindow(PaletteGrid& grid, long long row, long long column, int rows, int columns);
+
+		// Gets a single cell, generating its chunk if needed
+		Cell GetCell(long long row, long long column);
+
+		// Gets a chunk, generating it if needed
+		const PaletteGrid& GetChunk(ChunkCoord coord);
+
+		// Drops every loaded chunk
+		void Clear();
+
+		bool IsChunkLoaded(ChunkCoord coord)const;
+		size_t GetLoadedChunkCount()const;
+		size_t GetMemoryUsage()const;
+		size_t GetMemoryBudget()const;
+		int GetCaveDensityPercent()const;
+		unsigned int GetSeed()const;
+
+		// Gets the chunk that contains a world position
+		static ChunkCoord GetChunkCoord(long long row, long long column);
+
+	private:
+		struct Chunk
+		{
+			PaletteGrid Cells;
+			std::list<unsigned long long>::iterator Recent;
+		};
+
+		void LoadChunks(ChunkCoord first, ChunkCoord last);
+		void CarveOrigin(ChunkCoord origin, PaletteGrid& canvas, bool& bCarved);
+		void Touch(Chunk& chunk);
+		void EvictOverBudget(size_t pinnedCount);
+		size_t GetChunkBytes()const;
+
+		static unsigned long long GetKey(ChunkCoord coord);
+
+		Generator m_Generator;
+		unsigned int m_Seed;
+		int m_CaveDensity;
+		size_t m_MemoryBudget;
+		std::unordered_map<unsigned long long, Chunk> m_Chunks;
+		std::list<unsigned long long> m_RecentChunks;
+	};
+}
@@ -0,0 +1,217 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace WorldGenerator
+{
+	// Strided view over one line of a FlatGrid. Rows have a stride of 1 and
+	// columns have a stride equal to the row width.
+	template<typename T>
+	class GridSpan
+	{
+	public:
+		GridSpan(T* data, unsigned int count, unsigned int stride)
+		{
+			m_Data = data;
+			m_Count = count;
+			m_Stride = stride;
+		}
+
+		unsigned int size()const
+		{
+			return m_Count;
+		}
+
+		unsigned int Stride()const
+		{
+			return m_Stride;
+		}
+
+		T* data()const
+		{
+			return m_Data;
+		}
+
+		T& operator[](int index)const
+		{
+			return m_Data[(size_t)index * m_Stride];
+		}
+
+		T& at(int index)const
+		{
+			if (index < 0 || (unsigned int)index >= m_Count)
+				throw std::out_of_range("GridSpan::at");
+
+			return m_Data[(size_t)index * m_Stride];
+		}
+
+	private:
+		T* m_Data;
+		unsigned int m_Count;
+		unsigned int m_Stride;
+	};
+
+	// Row-major 2D grid kept in a single contiguous buffer
+	template<typename T>
+	class FlatGrid
+	{
+	public:
+		FlatGrid()
+		{
+			m_Rows = 0;
+			m_Columns = 0;
+		}
+
+		FlatGrid(int rows, int columns, const T& value = T())
+		{
+			m_Rows = 0;
+			m_Columns = 0;
+			assign(rows, columns, value);
+		}
+
+		unsigned int RowCount()const
+		{
+			return m_Rows;
+		}
+
+		unsigned int ColumnCount()const
+		{
+			return m_Columns;
+		}
+
+		// Distance in elements between two vertically adjacent cells
+		unsigned int Stride()const
+		{
+			return m_Columns;
+		}
+
+		size_t size()const
+		{
+			return m_Cells.size();
+		}
+
+		bool empty()const
+		{
+			return m_Cells.empty();
+		}
+
+		T* data()
+		{
+			return m_Cells.data();
+		}
+
+		const T* data()const
+		{
+			return m_Cells.data();
+		}
+
+		// Resizes the grid, keeping the cells that fall inside both the old and new bounds
+		void resize(int rows, int columns, const T& value = T())
+		{
+			rows = std::max(rows, 0);
+			columns = std::max(columns, 0);
+
+			if ((unsigned int)columns == m_Columns || m_Rows == 0)
+			{
+				m_Cells.resize((size_t)rows * columns, value);
+			}
+			else
+			{
+				std::vector<T> cells((size_t)rows * columns, value);
+				unsigned int keepRows = std::min(m_Rows, (unsigned int)rows);
+				unsigned int keepColumns = std::min(m_Columns, (unsigned int)columns);
+				for (unsigned int x = 0; x < keepRows; x++)
+				{
+					std::copy_n(m_Cells.begin() + (size_t)x * m_Columns, keepColumns, cells.begin() + (size_t)x * columns);
+				}
+
+				m_Cells.swap(cells);
+			}
+
+			m_Rows = rows;
+			m_Columns = columns;
+		}
+
+		// Discards the current contents and fills the grid with a single value
+		void assign(int rows, int columns, const T& value = T())
+		{
+			m_Rows = std::max(rows, 0);
+			m_Columns = std::max(columns, 0);
+			m_Cells.assign((size_t)m_Rows * m_Columns, value);
+		}
+
+		// Changes the dimensions without keeping the old layout. Use when every cell is about to be overwritten
+		void reshape(int rows, int columns)
+		{
+			m_Rows = std::max(rows, 0);
+			m_Columns = std::max(columns, 0);
+			m_Cells.resize((size_t)m_Rows * m_Columns);
+		}
+
+		void fill(const T& value)
+		{
+			std::fill(m_Cells.begin(), m_Cells.end(), value);
+		}
+
+		void clear()
+		{
+			m_Rows = 0;
+			m_Columns = 0;
+			m_Cells.clear();
+		}
+
+		GridSpan<T> Row(int x)
+		{
+			return GridSpan<T>(m_Cells.data() + (size_t)x * m_Columns, m_Columns, 1);
+		}
+
+		GridSpan<const T> Row(int x)const
+		{
+			return GridSpan<const T>(m_Cells.data() + (size_t)x * m_Columns, m_Columns, 1);
+		}
+
+		GridSpan<T> Column(int y)
+		{
+			return GridSpan<T>(m_Cells.data() + y, m_Rows, m_Columns);
+		}
+
+		GridSpan<const T> Column(int y)const
+		{
+			return GridSpan<const T>(m_Cells.data() + y, m_Rows, m_Columns);
+		}
+
+		GridSpan<T> at(int x)
+		{
+			if (x < 0 || (unsigned int)x >= m_Rows)
+				throw std::out_of_range("FlatGrid::at");
+
+			return Row(x);
+		}
+
+		GridSpan<const T> at(int x)const
+		{
+			if (x < 0 || (unsigned int)x >= m_Rows)
+				throw std::out_of_range("FlatGrid::at");
+
+			return Row(x);
+		}
+
+		GridSpan<T> operator[](int x)
+		{
+			return Row(x);
+		}
+
+		GridSpan<const T> operator[](int x)const
+		{
+			return Row(x);
+		}
+
+	private:
+		unsigned int m_Rows;
+		unsigned int m_Columns;
+		std::vector<T> m_Cells;
+	};
+}
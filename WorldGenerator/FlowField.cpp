@@ -0,0 +1,429 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "FlowField.h"
+#include <functional>
+
+namespace WorldGenerator
+{
+	// Rows and words of the frontier grown per pool task
+	static const int FLOW_TILE_ROWS = 16;
+	static const int FLOW_TILE_WORDS = 1;
+
+	// Row and column offsets in FlowDirection order
+	static const int FLOW_OFFSETS[8][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }, { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } };
+
+	const unsigned int FlowField::UNREACHABLE;
+
+	FlowField::FlowField()
+	{
+	}
+
+	void FlowField::Build(const WorldGrid& grid, const std::vector<std::pair<int, int>>& sources, ThreadPool* pool)
+	{
+		Build(grid.GetPassableLayer(), sources, pool);
+	}
+
+	void FlowField::Build(const BitGrid& passable, const std::vector<std::pair<int, int>>& sources, ThreadPool* pool)
+	{
+		const int rows = (int)passable.RowCount();
+		const int columns = (int)passable.ColumnCount();
+		const int wordBits = (int)BitGrid::WORD_BITS;
+		const int wordsPerRow = (int)passable.WordsPerRow();
+		m_Passable = passable;
+		m_Sources = sources;
+		m_SourceCells.assign(rows, columns);
+		m_Distances.assign(rows, columns, UNREACHABLE);
+		m_Directions.reshape(rows, columns);
+
+		// The frontier holds the cells reached by the last step. The next buffer still holds the
+		// frontier from the step before, so tiles that had any must be rewritten even when
+		// nothing reaches them now
+		const int tileRows = (rows + FLOW_TILE_ROWS - 1) / FLOW_TILE_ROWS;
+		const int tileColumns = (wordsPerRow + FLOW_TILE_WORDS - 1) / FLOW_TILE_WORDS;
+		BitGrid frontier(rows, columns);
+		BitGrid next(rows, columns);
+		BitGrid visited(rows, columns);
+		std::vector<unsigned char> bTilesReached((size_t)tileRows * tileColumns, 0);
+		std::vector<unsigned int> tileStamps((size_t)tileRows * tileColumns, 0);
+		std::vector<unsigned int> frontierTiles;
+		std::vector<unsigned int> previousTiles;
+		std::vector<unsigned int> activeTiles;
+
+		for (const std::pair<int, int>& source : sources)
+		{
+			if (source.first < 0 || source.first >= rows || source.second < 0 || source.second >= columns)
+				continue;
+
+			// Blocked sources are remembered, so they start pulling once an update opens them
+			m_SourceCells.Set(source.first, source.second, true);
+			if (!m_Passable.Get(source.first, source.second) || visited.Get(source.first, source.second))
+				continue;
+
+			frontier.Set(source.first, source.second, true);
+			visited.Set(source.first, source.second, true);
+			m_Distances[source.first][source.second] = 0;
+
+			const unsigned int tile = (source.first / FLOW_TILE_ROWS) * tileColumns + (source.second / wordBits) / FLOW_TILE_WORDS;
+			if (!tileStamps[tile])
+			{
+				tileStamps[tile] = 1;
+				frontierTiles.push_back(tile);
+			}
+		}
+
+		for (unsigned int distance = 1; !frontierTiles.empty(); distance++)
+		{
+			// A tile can only be reached from itself or the tiles beside it
+			const unsigned int stamp = distance + 1;
+			activeTiles.clear();
+			auto addTile = [&](int tileRow, int tileColumn)
+			{
+				if (tileRow < 0 || tileRow >= tileRows || tileColumn < 0 || tileColumn >= tileColumns)
+					return;
+
+				const unsigned int tile = tileRow * tileColumns + tileColumn;
+				if (tileStamps[tile] != stamp)
+				{
+					tileStamps[tile] = stamp;
+					activeTiles.push_back(tile);
+				}
+			};
+
+			for (unsigned int tile : frontierTiles)
+			{
+				const int tileRow = tile / tileColumns;
+				const int tileColumn = tile % tileColumns;
+				addTile(tileRow, tileColumn);
+				addTile(tileRow - 1, tileColumn);
+				addTile(tileRow + 1, tileColumn);
+				addTile(tileRow, tileColumn - 1);
+				addTile(tileRow, tileColumn + 1);
+			}
+
+			for (unsigned int tile : previousTiles)
+			{
+				addTile(tile / tileColumns, tile % tileColumns);
+			}
+
+			ThreadPool::ParallelFor(pool, (unsigned int)activeTiles.size(), [&](unsigned int entry, unsigned int)
+			{
+				const unsigned int tile = activeTiles[entry];
+				const int firstRow = (tile / tileColumns) * FLOW_TILE_ROWS;
+				const int lastRow = std::min(firstRow + FLOW_TILE_ROWS, rows);
+				const int firstWord = (tile % tileColumns) * FLOW_TILE_WORDS;
+				const int lastWord = std::min(firstWord + FLOW_TILE_WORDS, wordsPerRow);
+				bool bReached = false;
+				for (int x = firstRow; x < lastRow; x++)
+				{
+					const unsigned long long* cells = frontier.RowWords(x);
+					const unsigned long long* above = (x > 0) ? frontier.RowWords(x - 1) : nullptr;
+					const unsigned long long* below = (x + 1 < rows) ? frontier.RowWords(x + 1) : nullptr;
+					const unsigned long long* open = m_Passable.RowWords(x);
+					unsigned long long* reached = next.RowWords(x);
+					unsigned long long* seen = visited.RowWords(x);
+					for (int word = firstWord; word < lastWord; word++)
+					{
+						// Grow the frontier a cell in each direction, carrying bits across word edges
+						unsigned long long grown = cells[word] | (cells[word] << 1) | (cells[word] >> 1);
+						if (word > 0)
+							grown |= cells[word - 1] >> (wordBits - 1);
+						if (word + 1 < wordsPerRow)
+							grown |= cells[word + 1] << (wordBits - 1);
+						if (above)
+							grown |= above[word];
+						if (below)
+							grown |= below[word];
+
+						const unsigned long long bits = grown & open[word] & ~seen[word];
+						reached[word] = bits;
+						seen[word] |= bits;
+						bReached |= bits != 0;
+
+						unsigned int* distances = m_Distances[x].data() + word * wordBits;
+						for (unsigned long long rest = bits; rest; rest &= rest - 1)
+						{
+							distances[BitGrid::CountTrailingZeros(rest)] = distance;
+						}
+					}
+				}
+
+				bTilesReached[tile] = bReached;
+			});
+
+			previousTiles.swap(frontierTiles);
+			frontierTiles.clear();
+			for (unsigned int tile : activeTiles)
+			{
+				if (bTilesReached[tile])
+					frontierTiles.push_back(tile);
+			}
+
+			std::swap(frontier, next);
+		}
+
+		const unsigned int bandCount = (rows + FLOW_TILE_ROWS - 1) / FLOW_TILE_ROWS;
+		ThreadPool::ParallelFor(pool, bandCount, [&](unsigned int band, unsigned int)
+		{
+			const int lastRow = std::min((int)(band + 1) * FLOW_TILE_ROWS, rows);
+			for (int x = band * FLOW_TILE_ROWS; x < lastRow; x++)
+			{
+				for (int y = 0; y < columns; y++)
+				{
+					UpdateDirection(x, y);
+				}
+			}
+		});
+	}
+
+	void FlowField::Update(const WorldGrid& grid, std::pair<int, int> rowRange, std::pair<int, int> columnRange, ThreadPool* pool)
+	{
+		Update(grid.GetPassableLayer(), rowRange, columnRange, pool);
+	}
+
+	void FlowField::Update(const BitGrid& passable, std::pair<int, int> rowRange, std::pair<int, int> columnRange, ThreadPool* pool)
+	{
+		const int rows = (int)passable.RowCount();
+		const int columns = (int)passable.ColumnCount();
+		if (m_Passable.RowCount() != (unsigned int)rows || m_Passable.ColumnCount() != (unsigned int)columns)
+		{
+			std::vector<std::pair<int, int>> sources = m_Sources;
+			Build(passable, sources, pool);
+			return;
+		}
+
+		m_Queue.clear();
+		m_Heap.clear();
+		m_Changed.clear();
+
+		// Cells can only be supported by a side neighbour one step closer
+		auto forSides = [&](unsigned int cell, auto visit)
+		{
+			const int x = cell / columns;
+			const int y = cell % columns;
+			if (x > 0)
+				visit(cell - columns);
+			if (x + 1 < rows)
+				visit(cell + columns);
+			if (y > 0)
+				visit(cell - 1);
+			if (y + 1 < columns)
+				visit(cell + 1);
+		};
+
+		unsigned int* distances = m_Distances.data();
+		auto queueDependents = [&](unsigned int cell, unsigned int distance)
+		{
+			forSides(cell, [&](unsigned int side)
+			{
+				if (distances[side] == distance + 1)
+					m_Queue.push_back(side);
+			});
+		};
+
+		// Copy the changes. Cells that closed lose their distance and may leave the cells
+		// beyond them without a way back. Cells that opened get one below
+		for (int x = std::max(rowRange.first, 0); x < std::min(rowRange.second, rows); x++)
+		{
+			for (int y = std::max(columnRange.first, 0); y < std::min(columnRange.second, columns); y++)
+			{
+				const bool bOpen = passable.Get(x, y);
+				if (bOpen == m_Passable.Get(x, y))
+					continue;
+
+				const unsigned int cell = x * columns + y;
+				m_Passable.Set(x, y, bOpen);
+				m_Changed.push_back(cell);
+				if (!bOpen && distances[cell] != UNREACHABLE)
+				{
+					const unsigned int distance = distances[cell];
+					distances[cell] = UNREACHABLE;
+					queueDependents(cell, distance);
+				}
+			}
+		}
+
+		// Drop every cell left with no side neighbour one step closer, and check the cells
+		// that were counting on it in turn
+		while (!m_Queue.empty())
+		{
+			const unsigned int cell = m_Queue.back();
+			m_Queue.pop_back();
+
+			const unsigned int distance = distances[cell];
+			if (distance == UNREACHABLE || distance == 0)
+				continue;
+
+			bool bSupported = false;
+			forSides(cell, [&](unsigned int side)
+			{
+				bSupported |= distances[side] == distance - 1;
+			});
+
+			if (bSupported)
+				continue;
+
+			distances[cell] = UNREACHABLE;
+			m_Changed.push_back(cell);
+			queueDependents(cell, distance);
+		}
+
+		// Give each dropped or opened cell the best distance its neighbours offer, then spread
+		// any improvement outward, nearest first
+		auto isFurther = std::greater<std::pair<unsigned int, unsigned int>>();
+		const size_t seedCount = m_Changed.size();
+		for (size_t index = 0; index < seedCount; index++)
+		{
+			const unsigned int cell = m_Changed[index];
+			if (!m_Passable.Get(cell / columns, cell % columns))
+				continue;
+
+			unsigned int best = UNREACHABLE;
+			if (m_SourceCells.Get(cell / columns, cell % columns))
+				best = 0;
+			else
+			{
+				forSides(cell, [&](unsigned int side)
+				{
+					if (distances[side] != UNREACHABLE)
+						best = std::min(best, distances[side] + 1);
+				});
+			}
+
+			if (best < distances[cell])
+			{
+				distances[cell] = best;
+				m_Heap.push_back(std::make_pair(best, cell));
+				std::push_heap(m_Heap.begin(), m_Heap.end(), isFurther);
+			}
+		}
+
+		while (!m_Heap.empty())
+		{
+			std::pop_heap(m_Heap.begin(), m_Heap.end(), isFurther);
+			const std::pair<unsigned int, unsigned int> entry = m_Heap.back();
+			m_Heap.pop_back();
+			if (entry.first != distances[entry.second])
+				continue;
+
+			forSides(entry.second, [&](unsigned int side)
+			{
+				if (distances[side] > entry.first + 1 && m_Passable.Get(side / columns, side % columns))
+				{
+					distances[side] = entry.first + 1;
+					m_Changed.push_back(side);
+					m_Heap.push_back(std::make_pair(entry.first + 1, side));
+					std::push_heap(m_Heap.begin(), m_Heap.end(), isFurther);
+				}
+			});
+		}
+
+		// Directions read the neighbours' distances, so point every changed cell and its
+		// neighbours again
+		for (unsigned int cell : m_Changed)
+		{
+			const int x = cell / columns;
+			const int y = cell % columns;
+			UpdateDirection(x, y);
+			for (const int* offset : FLOW_OFFSETS)
+			{
+				if (x + offset[0] >= 0 && x + offset[0] < rows && y + offset[1] >= 0 && y + offset[1] < columns)
+					UpdateDirection(x + offset[0], y + offset[1]);
+			}
+		}
+	}
+
+	void FlowField::clear()
+	{
+		m_Passable.clear();
+		m_SourceCells.clear();
+		m_Sources.clear();
+		m_Distances.clear();
+		m_Directions.clear();
+	}
+
+	unsigned int FlowField::RowCount() const
+	{
+		return m_Distances.RowCount();
+	}
+
+	unsigned int FlowField::ColumnCount() const
+	{
+		return m_Distances.ColumnCount();
+	}
+
+	unsigned int FlowField::GetDistance(int x, int y) const
+	{
+		if (x < 0 || (unsigned int)x >= m_Distances.RowCount() || y < 0 || (unsigned int)y >= m_Distances.ColumnCount())
+			return UNREACHABLE;
+
+		return m_Distances[x][y];
+	}
+
+	FlowDirection FlowField::GetDirection(int x, int y) const
+	{
+		if (x < 0 || (unsigned int)x >= m_Directions.RowCount() || y < 0 || (unsigned int)y >= m_Directions.ColumnCount())
+			return FLOW_NONE;
+
+		return m_Directions[x][y];
+	}
+
+	std::pair<int, int> FlowField::GetNextCell(int x, int y) const
+	{
+		std::pair<int, int> offset = GetOffset(GetDirection(x, y));
+		return std::make_pair(x + offset.first, y + offset.second);
+	}
+
+	const FlatGrid<unsigned int>& FlowField::GetDistances() const
+	{
+		return m_Distances;
+	}
+
+	const FlatGrid<FlowDirection>& FlowField::GetDirections() const
+	{
+		return m_Directions;
+	}
+
+	const std::vector<std::pair<int, int>>& FlowField::GetSources() const
+	{
+		return m_Sources;
+	}
+
+	std::pair<int, int> FlowField::GetOffset(FlowDirection direction)
+	{
+		if (direction >= FLOW_NONE)
+			return std::make_pair(0, 0);
+
+		return std::make_pair(FLOW_OFFSETS[direction][0], FLOW_OFFSETS[direction][1]);
+	}
+
+	void FlowField::UpdateDirection(int x, int y)
+	{
+		FlowDirection best = FLOW_NONE;
+		unsigned int bestDistance = m_Distances[x][y];
+		if (bestDistance != 0 && bestDistance != UNREACHABLE)
+		{
+			// Side neighbours of a reachable cell are reachable exactly when they are open, so
+			// distances alone tell which steps are allowed
+			const int rows = (int)m_Distances.RowCount();
+			const int columns = (int)m_Distances.ColumnCount();
+			unsigned int distances[8];
+			for (int direction = 0; direction < FLOW_NONE; direction++)
+			{
+				const int dx = FLOW_OFFSETS[direction][0];
+				const int dy = FLOW_OFFSETS[direction][1];
+				const bool bOnMap = x + dx >= 0 && x + dx < rows && y + dy >= 0 && y + dy < columns;
+				distances[direction] = bOnMap ? m_Distances[x + dx][y + dy] : UNREACHABLE;
+				if (dx && dy && (distances[(dx < 0) ? FLOW_UP : FLOW_DOWN] == UNREACHABLE || distances[(dy < 0) ? FLOW_LEFT : FLOW_RIGHT] == UNREACHABLE))
+					continue;
+
+				if (distances[direction] < bestDistance)
+				{
+					best = (FlowDirection)direction;
+					bestDistance = distances[direction];
+				}
+			}
+		}
+
+		m_Directions[x][y] = best;
+	}
+}
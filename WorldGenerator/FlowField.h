@@ -0,0 +1,87 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "WorldGrid.h"
+#include "ThreadPool.h"
+
+namespace WorldGenerator
+{
+	// Way a flow field cell points, toward lower distance. Up is the row above
+	enum FlowDirection : unsigned char
+	{
+		FLOW_UP,
+		FLOW_DOWN,
+		FLOW_LEFT,
+		FLOW_RIGHT,
+		FLOW_UP_LEFT,
+		FLOW_UP_RIGHT,
+		FLOW_DOWN_LEFT,
+		FLOW_DOWN_RIGHT,
+		// Sources, and cells that are blocked or cannot reach a source
+		FLOW_NONE,
+	};
+
+	// Distance from every passable cell to the nearest of a set of sources, and the way to
+	// step from each cell to get closer. Lets any number of agents head for the same goals,
+	// such as a landmark's exits or the walker start, from one search.
+	// Distances count steps between side neighbours. Directions may also step diagonally
+	// when both cells beside the step are open, so agents do not zigzag across open ground
+	class FlowField
+	{
+	public:
+		// Distance of cells that cannot reach a source
+		static const unsigned int UNREACHABLE = ~0u;
+
+		FlowField();
+
+		// Searches out from every source at once. Each step grows the frontier, kept as one bit
+		// per cell, by a cell in every direction 64 cells per word, with tiles of the map grown
+		// in parallel and tiles far from the frontier skipped. Sources off the map are ignored, and
+		// blocked ones only count once they open. Runs on the calling thread when no pool is given
+		void Build(const WorldGrid& grid, const std::vector<std::pair<int, int>>& sources, ThreadPool* pool = nullptr);
+		void Build(const BitGrid& passable, const std::vector<std::pair<int, int>>& sources, ThreadPool* pool = nullptr);
+
+		// Catches up with cells changed in [rowRange.first, rowRange.second) x [columnRange.first, columnRange.second).
+		// Only the cells whose distance changes, and their neighbours, are visited, always on the
+		// calling thread. Rebuilds everything when the grid has changed size, which is the only
+		// time pool is used
+		void Update(const WorldGrid& grid, std::pair<int, int> rowRange, std::pair<int, int> columnRange, ThreadPool* pool = nullptr);
+		void Update(const BitGrid& passable, std::pair<int, int> rowRange, std::pair<int, int> columnRange, ThreadPool* pool = nullptr);
+
+		void clear();
+
+		unsigned int RowCount()const;
+		unsigned int ColumnCount()const;
+
+		// Steps to the nearest source, or UNREACHABLE
+		unsigned int GetDistance(int x, int y)const;
+
+		FlowDirection GetDirection(int x, int y)const;
+
+		// Cell to step to from (x, y), or (x, y) itself when it has nowhere to go
+		std::pair<int, int> GetNextCell(int x, int y)const;
+
+		const FlatGrid<unsigned int>& GetDistances()const;
+		const FlatGrid<FlowDirection>& GetDirections()const;
+		const std::vector<std::pair<int, int>>& GetSources()const;
+
+		// Row and column offsets of each direction
+		static std::pair<int, int> GetOffset(FlowDirection direction);
+
+	private:
+		// Points the cell at its open neighbour with the lowest distance
+		void UpdateDirection(int x, int y);
+
+		// Copy of the layer the field was built from, so Update can tell what changed
+		BitGrid m_Passable;
+		BitGrid m_SourceCells;
+		std::vector<std::pair<int, int>> m_Sources;
+		FlatGrid<unsigned int> m_Distances;
+		FlatGrid<FlowDirection> m_Directions;
+
+		// Kept between updates so they reuse their storage
+		std::vector<unsigned int> m_Queue;
+		std::vector<std::pair<unsigned int, unsigned int>> m_Heap;
+		std::vector<unsigned int> m_Changed;
+	};
+}
@@ -0,0 +1,288 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "GenerationCache.h"
+#include "Random.h"
+#include <atomic>
+#include <cstdio>
+
+namespace WorldGenerator
+{
+	// Folds value into a running hash
+	static unsigned long long HashValue(unsigned long long hash, unsigned long long value)
+	{
+		return MixSeed(hash ^ value);
+	}
+
+	static unsigned long long HashString(unsigned long long hash, const std::string& text)
+	{
+		hash = HashValue(hash, text.size());
+		for (char character : text)
+		{
+			hash = HashValue(hash, (unsigned char)character);
+		}
+
+		return hash;
+	}
+
+	// Memory held by a grid and its layers
+	static size_t GetGridBytes(const WorldGrid& grid)
+	{
+		const BitGrid& layer = grid.GetPassableLayer();
+		size_t layerBytes = (size_t)layer.RowCount() * layer.WordsPerRow() * sizeof(unsigned long long);
+		return grid.size() * sizeof(Cell) + layerBytes * (1 + CellSet::PALETTE_SIZE);
+	}
+
+	// Whether the file was generated from the settings in info and the cells of cellSet
+	static bool MatchesInfo(const MapFile& file, const MapFileInfo& info, const CellSet* cellSet)
+	{
+		const MapFileInfo stored = file.GetInfo();
+
+		// The header keeps at most the first 31 characters of the name
+		const size_t nameLength = sizeof(file.GetHeader().CellSetName) - 1;
+		if (stored.CellSetName != info.CellSetName.substr(0, nameLength) || stored.Seed != info.Seed ||
+			stored.MaxWalkers != info.MaxWalkers || stored.MaxPathLength != info.MaxPathLength ||
+			stored.PathDivergencePercent != info.PathDivergencePercent || stored.Magnification != info.Magnification ||
+			stored.RandomEngine != info.RandomEngine || stored.MapSize != info.MapSize || stored.StartPosition != info.StartPosition ||
+			stored.bAutoTiling != info.bAutoTiling || stored.bPerWalkerStreams != info.bPerWalkerStreams)
+			return false;
+
+		if (!cellSet)
+			return false;
+
+		for (unsigned int index = 0; index < CellSet::PALETTE_SIZE; index++)
+		{
+			const Cell& storedCell = file.GetHeader().Palette[index];
+			const Cell& cell = cellSet->GetPalette()[index];
+			if (storedCell.Depth != cell.Depth || storedCell.Passable != cell.Passable || storedCell.Type != cell.Type)
+				return false;
+		}
+
+		return true;
+	}
+
+	static void DecodeIndices(const PaletteGrid& indices, const Cell* palette, WorldGrid& grid)
+	{
+		MagnifiedView<unsigned char> view(indices, std::make_pair(0, (int)indices.RowCount()), std::make_pair(0, (int)indices.ColumnCount()), std::make_pair(1, 1));
+		view.Materialize(grid, [palette](unsigned char index) { return palette[index]; });
+		grid.RebuildLayers();
+	}
+
+	GenerationCache::GenerationCache(size_t maxBytes, const std::string& directory)
+	{
+		m_Directory = directory;
+		m_MaxBytes = maxBytes;
+		m_Bytes = 0;
+		m_MemoryHits = 0;
+		m_DiskHits = 0;
+		m_Misses = 0;
+	}
+
+	bool GenerationCache::GenerateMap(const Generator& generator, WorldGrid& grid, std::pair<int, int> start, unsigned int seed)
+	{
+		if (seed == 0)
+			return generator.GenerateMap(grid, start, seed);
+
+		const unsigned long long key = GetKey(generator, start, seed);
+		const MapFileInfo info(generator, seed, start);
+		if (Find(key, info, generator.GetCellSet(), grid))
+			return true;
+
+		// Threads missing the same key at once each generate it. The maps are identical, so either insert is fine
+		if (m_Directory.empty())
+		{
+			if (!generator.GenerateMap(grid, start, seed))
+				return false;
+		}
+		else
+		{
+			// Files keep palette indices, so generate those and decode them the way GenerateMap would
+			PaletteGrid indices;
+			if (!generator.GenerateMap(indices, start, seed))
+				return false;
+
+			DecodeIndices(indices, indices.GetCellSet()->GetPalette(), grid);
+			WriteFile(key, indices, info);
+		}
+
+		InsertInMemory(key, grid);
+		return true;
+	}
+
+	bool GenerationCache::Find(const Generator& generator, std::pair<int, int> start, unsigned int seed, WorldGrid& grid)
+	{
+		return Find(GetKey(generator, start, seed), MapFileInfo(generator, seed, start), generator.GetCellSet(), grid);
+	}
+
+	bool GenerationCache::Find(unsigned long long key, const MapFileInfo& info, const CellSet* cellSet, WorldGrid& grid)
+	{
+		if (FindInMemory(key, grid))
+			return true;
+
+		if (!m_Directory.empty() && ReadFile(key, info, cellSet, grid))
+		{
+			InsertInMemory(key, grid);
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_DiskHits++;
+			return true;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Misses++;
+		return false;
+	}
+
+	unsigned long long GenerationCache::GetKey(const Generator& generator, std::pair<int, int> start, unsigned int seed)
+	{
+		unsigned long long hash = HashValue(FORMAT_VERSION, MapFile::VERSION);
+		hash = HashString(hash, generator.GetCellSetName());
+
+		// Sets can be registered again under an old name, so the cells count as well as the name
+		const CellSet* cellSet = generator.GetCellSet();
+		for (unsigned int index = 0; cellSet && index < CellSet::PALETTE_SIZE; index++)
+		{
+			const Cell& cell = cellSet->GetPalette()[index];
+			hash = HashValue(hash, ((unsigned long long)(unsigned short)cell.Depth << 16) | ((unsigned long long)cell.Passable << 8) | (unsigned char)cell.Type);
+		}
+
+		const int settings[] = {
+			generator.GetMapRows(),
+			generator.GetMapColumns(),
+			generator.GetMaxWalkers(),
+			generator.GetMaxPathLength(),
+			generator.GetPathDivergencePercent(),
+			generator.GetMagnification().first,
+			generator.GetMagnification().second,
+			generator.IsAutoTiling() ? 1 : 0,
+			(int)generator.GetRandomEngine(),
+			// Any worker count walks the same way, but differently from none
+			generator.GetWorkerThreads() ? 1 : 0,
+			start.first,
+			start.second,
+		};
+
+		for (int setting : settings)
+		{
+			hash = HashValue(hash, (unsigned int)setting);
+		}
+
+		return HashValue(hash, seed);
+	}
+
+	void GenerationCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Entries.clear();
+		m_Index.clear();
+		m_Bytes = 0;
+	}
+
+	size_t GenerationCache::GetByteCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Bytes;
+	}
+
+	size_t GenerationCache::GetEntryCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Entries.size();
+	}
+
+	unsigned long long GenerationCache::GetMemoryHits() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_MemoryHits;
+	}
+
+	unsigned long long GenerationCache::GetDiskHits() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_DiskHits;
+	}
+
+	unsigned long long GenerationCache::GetMisses() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Misses;
+	}
+
+	bool GenerationCache::FindInMemory(unsigned long long key, WorldGrid& grid)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto found = m_Index.find(key);
+		if (found == m_Index.end())
+			return false;
+
+		// Move to the front as the most recently used
+		m_Entries.splice(m_Entries.begin(), m_Entries, found->second);
+		grid = found->second->Grid;
+		m_MemoryHits++;
+		return true;
+	}
+
+	void GenerationCache::InsertInMemory(unsigned long long key, const WorldGrid& grid)
+	{
+		const size_t bytes = GetGridBytes(grid);
+		if (bytes > m_MaxBytes)
+			return;
+
+		// Copy before locking so other threads are not held up by it
+		Entry entry = { key, bytes, grid };
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_Index.find(key) != m_Index.end())
+			return;
+
+		while (m_Bytes + bytes > m_MaxBytes)
+		{
+			m_Bytes -= m_Entries.back().Bytes;
+			m_Index.erase(m_Entries.back().Key);
+			m_Entries.pop_back();
+		}
+
+		m_Entries.push_front(std::move(entry));
+		m_Index[key] = m_Entries.begin();
+		m_Bytes += bytes;
+	}
+
+	bool GenerationCache::ReadFile(unsigned long long key, const MapFileInfo& info, const CellSet* cellSet, WorldGrid& grid) const
+	{
+		MapFile file;
+		if (!file.Open(GetPath(key)) || file.GetHeader().CellBytes != 1)
+			return false;
+
+		// The file name is only a hash, so check the header really is this map
+		if (!MatchesInfo(file, info, cellSet))
+			return false;
+
+		// Same cells as the current set, checked above
+		PaletteGrid indices;
+		if (!file.Read(indices))
+			return false;
+
+		DecodeIndices(indices, file.GetHeader().Palette, grid);
+		return true;
+	}
+
+	void GenerationCache::WriteFile(unsigned long long key, const PaletteGrid& indices, const MapFileInfo& info) const
+	{
+		// Write under a unique name and rename, so readers never see a half written file
+		static std::atomic<unsigned int> s_WriteCount(0);
+		const std::string path = GetPath(key);
+		const std::string temporaryPath = path + "." + std::to_string(s_WriteCount++) + ".tmp";
+		if (!MapFile::Write(temporaryPath, indices, info, true))
+		{
+			std::remove(temporaryPath.c_str());
+			return;
+		}
+
+		if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+			std::remove(temporaryPath.c_str());
+	}
+
+	std::string GenerationCache::GetPath(unsigned long long key) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.wgm", key);
+		return m_Directory + "/" + name;
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "Generator.h"
+#include "MapFile.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace WorldGenerator
+{
+	// Remembers generated maps so asking for the same map again is a lookup rather than a walk.
+	// Maps are keyed by a hash of every generator setting, the start and the seed, and kept in
+	// memory up to a byte budget, dropping the least recently used first. With a directory set,
+	// maps are also written there as compressed palette map files and read back on a memory miss.
+	// A file is only used when the settings in its header match the generator's, so a stale file
+	// or a key collision counts as a miss. One cache may be shared by many threads
+	class GenerationCache
+	{
+	public:
+		// Bumped whenever generation changes in a way that makes existing maps stale
+		static const unsigned int FORMAT_VERSION = 1;
+
+		// directory must exist already. An empty directory keeps everything in memory
+		GenerationCache(size_t maxBytes, const std::string& directory = std::string());
+
+		GenerationCache(const GenerationCache&) = delete;
+		GenerationCache& operator=(const GenerationCache&) = delete;
+
+		// Copies the cached map into grid, generating and caching it first when needed. Maps with
+		// seed 0 are seeded from the clock, so they are generated every time and never cached
+		bool GenerateMap(const Generator& generator, WorldGrid& grid, std::pair<int, int> startPosition, unsigned int seed);
+
+		// Looks a map up in memory, then on disk. Returns false when neither has it
+		bool Find(const Generator& generator, std::pair<int, int> startPosition, unsigned int seed, WorldGrid& grid);
+
+		// Hash of everything that decides the map, the same on every platform and run
+		static unsigned long long GetKey(const Generator& generator, std::pair<int, int> startPosition, unsigned int seed);
+
+		// Empties the memory tier. Files on disk are left alone
+		void Clear();
+
+		size_t GetByteCount()const;
+		size_t GetEntryCount()const;
+		unsigned long long GetMemoryHits()const;
+		unsigned long long GetDiskHits()const;
+		unsigned long long GetMisses()const;
+
+	private:
+		struct Entry
+		{
+			unsigned long long Key;
+			size_t Bytes;
+			WorldGrid Grid;
+		};
+
+		bool FindInMemory(unsigned long long key, WorldGrid& grid);
+		void InsertInMemory(unsigned long long key, const WorldGrid& grid);
+		bool Find(unsigned long long key, const MapFileInfo& info, const CellSet* cellSet, WorldGrid& grid);
+		// Reads the file for key when its header matches info and the cell set's palette
+		bool ReadFile(unsigned long long key, const MapFileInfo& info, const CellSet* cellSet, WorldGrid& grid)const;
+		void WriteFile(unsigned long long key, const PaletteGrid& indices, const MapFileInfo& info)const;
+		std::string GetPath(unsigned long long key)const;
+
+		// Most recently used first
+		std::list<Entry> m_Entries;
+		std::unordered_map<unsigned long long, std::list<Entry>::iterator> m_Index;
+		mutable std::mutex m_Mutex;
+		std::string m_Directory;
+		size_t m_MaxBytes;
+		size_t m_Bytes;
+		unsigned long long m_MemoryHits;
+		unsigned long long m_DiskHits;
+		unsigned long long m_Misses;
+	};
+}
@@ -0,0 +1,100 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include <chrono>
+#include <utility>
+
+// Set to 0 to compile every statistics counter and timer out of the generator
+#ifndef WORLDGEN_STATS
+#define WORLDGEN_STATS 1
+#endif
+
+namespace WorldGenerator
+{
+	// Counters describing how a map was generated. Filled by Generator::GenerateMap when
+	// a GenerationStats is passed in, and left untouched when WORLDGEN_STATS is 0
+	struct GenerationStats
+	{
+		GenerationStats()
+		{
+			Reset();
+		}
+
+		void Reset()
+		{
+			WalkerSteps = 0;
+			WalkersSpawned = 0;
+			WalkersRetired = 0;
+			FrontBlocked = 0;
+			DeadEnds = 0;
+			CellsCarved = 0;
+			CellsRecarved = 0;
+			RowRange = std::make_pair(0, 0);
+			ColumnRange = std::make_pair(0, 0);
+			WalkSeconds = 0;
+			TilingSeconds = 0;
+			MagnifySeconds = 0;
+		}
+
+		// Adds the counters of other. Bounds and times are left alone
+		void Merge(const GenerationStats& other)
+		{
+			WalkerSteps += other.WalkerSteps;
+			WalkersSpawned += other.WalkersSpawned;
+			WalkersRetired += other.WalkersRetired;
+			FrontBlocked += other.FrontBlocked;
+			DeadEnds += other.DeadEnds;
+			CellsCarved += other.CellsCarved;
+			CellsRecarved += other.CellsRecarved;
+		}
+
+		unsigned long long WalkerSteps;
+		unsigned long long WalkersSpawned;
+		unsigned long long WalkersRetired;
+		// Steps where the way ahead was off the map and the walker had to turn
+		unsigned long long FrontBlocked;
+		// Walkers retired because no direction was left, rather than by reaching their path length
+		unsigned long long DeadEnds;
+		// Cells turned into ground for the first time, and carves of cells that were already ground
+		unsigned long long CellsCarved;
+		unsigned long long CellsRecarved;
+		// Padded bounds of the carved area in map coordinates, both ends inclusive
+		std::pair<int, int> RowRange;
+		std::pair<int, int> ColumnRange;
+		double WalkSeconds;
+		double TilingSeconds;
+		// Cropping, magnifying and decoding into the output grid
+		double MagnifySeconds;
+	};
+
+	// Measures time only when there are stats to record it in
+	class StatsTimer
+	{
+	public:
+		StatsTimer(const GenerationStats* stats)
+		{
+			if (stats)
+				m_Start = std::chrono::steady_clock::now();
+		}
+
+		double Elapsed()const
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point m_Start;
+	};
+}
+
+#if WORLDGEN_STATS
+// Runs statement on the stats when they are being collected, e.g. WORLDGEN_STAT(stats, WalkerSteps++)
+#define WORLDGEN_STAT(stats, statement) do { if (stats) { (stats)->statement; } } while (0)
+#define WORLDGEN_STAT_TIMER(name, stats) WorldGenerator::StatsTimer name(stats)
+#define WORLDGEN_STAT_TIME(stats, field, timer) WORLDGEN_STAT(stats, field += (timer).Elapsed())
+#else
+// sizeof keeps the stats pointer referenced without evaluating anything
+#define WORLDGEN_STAT(stats, statement) do { (void)sizeof(stats); } while (0)
+#define WORLDGEN_STAT_TIMER(name, stats) do { } while (0)
+#define WORLDGEN_STAT_TIME(stats, field, timer) do { } while (0)
+#endif
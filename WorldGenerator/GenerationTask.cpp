@@ -0,0 +1,215 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "GenerationTask.h"
+#include <algorithm>
+#include <chrono>
+
+namespace WorldGenerator
+{
+	// Steps between clock checks when a step has a time budget
+	static const unsigned long long WALK_CHUNK_STEPS = 1024;
+
+	GenerationTask::GenerationTask(const Generator& generator, std::pair<int, int> start, unsigned int seed) :
+		m_Generator(generator),
+		m_Seed(seed),
+		m_WalkerSteps(0),
+		m_CellsCarved(0),
+		m_Phase(FAILED),
+		m_NextRow(0)
+	{
+		generator.ResetCanvas(m_Canvas, start);
+		if (!generator.BeginCarve(m_Canvas, start, m_Seed, m_RowRange, m_ColumnRange, &m_Stats))
+			return;
+
+		m_Walk = generator.StartWalk(m_Canvas, start, m_Seed, m_RowRange, m_ColumnRange, &m_Stats);
+		m_Phase = WALK;
+	}
+
+	bool GenerationTask::Step(const GenerationBudget& budget)
+	{
+		typedef std::chrono::steady_clock Clock;
+		const Clock::time_point startTime = Clock::now();
+		auto outOfTime = [&]()
+		{
+			return budget.Seconds > 0 && std::chrono::duration<double>(Clock::now() - startTime).count() >= budget.Seconds;
+		};
+
+		unsigned long long stepsLeft = budget.Steps ? budget.Steps : ~0ull;
+		while (m_Phase != DONE && m_Phase != FAILED && stepsLeft > 0)
+		{
+			if (m_Phase == WALK)
+			{
+				// Check the clock every chunk rather than every step
+				unsigned long long chunk = (budget.Seconds > 0) ? std::min(stepsLeft, WALK_CHUNK_STEPS) : stepsLeft;
+				WORLDGEN_STAT_TIMER(walkTimer, &m_Stats);
+				unsigned long long steps = m_Walk->Advance(chunk);
+				WORLDGEN_STAT_TIME(&m_Stats, WalkSeconds, walkTimer);
+
+				m_WalkerSteps += steps;
+				m_CellsCarved = m_Walk->GetCellsCarved();
+				stepsLeft -= std::min(stepsLeft, steps);
+				if (steps < chunk)
+				{
+					m_Walk.reset();
+					m_Generator.EndCarve(m_RowRange, m_ColumnRange, &m_Stats);
+					NextPhase();
+				}
+			}
+			else
+			{
+				// A time budget alone still works through rows in slices so the clock gets checked
+				const int rowCount = GetPhaseRowCount();
+				const unsigned long long slice = (budget.Seconds > 0) ? std::min<unsigned long long>(stepsLeft, 16) : stepsLeft;
+				const int last = (int)std::min<unsigned long long>(rowCount, m_NextRow + slice);
+				RunRows(m_NextRow, last);
+
+				stepsLeft -= std::min<unsigned long long>(stepsLeft, last - m_NextRow);
+				m_NextRow = last;
+				if (m_NextRow >= rowCount)
+					NextPhase();
+			}
+
+			if (outOfTime())
+				break;
+		}
+
+		return m_Phase != DONE && m_Phase != FAILED;
+	}
+
+	bool GenerationTask::Finish()
+	{
+		while (Step(GenerationBudget()))
+		{
+		}
+
+		return m_Phase == DONE;
+	}
+
+	void GenerationTask::RunRows(int first, int last)
+	{
+		switch (m_Phase)
+		{
+		case TILE:
+		{
+			WORLDGEN_STAT_TIMER(tilingTimer, &m_Stats);
+			std::pair<int, int> rows(m_RowRange.first + first, m_RowRange.first + last);
+			m_Generator.PostProcess(m_Canvas, rows, m_ColumnRange);
+			WORLDGEN_STAT_TIME(&m_Stats, TilingSeconds, tilingTimer);
+			break;
+		}
+		case MAGNIFY:
+		{
+			WORLDGEN_STAT_TIMER(magnifyTimer, &m_Stats);
+			const Cell* palette = m_Canvas.GetGrid().GetCellSet()->GetPalette();
+			MagnifiedView<unsigned char> view = m_Generator.GetResultView(m_Canvas, m_RowRange, m_ColumnRange);
+			if (first == 0)
+				m_Grid.reshape(view.RowCount(), view.ColumnCount());
+
+			// Rows here are view rows, each of which fills Magnification rows of the grid
+			view.MaterializeRows(m_Grid, [palette](unsigned char index) { return palette[index]; }, first, last);
+			WORLDGEN_STAT_TIME(&m_Stats, MagnifySeconds, magnifyTimer);
+			break;
+		}
+		case LAYERS:
+		{
+			WORLDGEN_STAT_TIMER(magnifyTimer, &m_Stats);
+			m_Grid.RebuildLayers(first, last);
+			WORLDGEN_STAT_TIME(&m_Stats, MagnifySeconds, magnifyTimer);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	int GenerationTask::GetPhaseRowCount() const
+	{
+		switch (m_Phase)
+		{
+		case TILE:
+		case MAGNIFY:
+			// Same half-open use of the padded range as PostProcess and ProcessResults
+			return m_RowRange.second - m_RowRange.first;
+		case LAYERS:
+			return m_Grid.RowCount();
+		default:
+			return 0;
+		}
+	}
+
+	void GenerationTask::NextPhase()
+	{
+		m_NextRow = 0;
+		m_Phase = (Phase)(m_Phase + 1);
+
+		// Skip phases with nothing to do, so Step never stalls on an empty one
+		while (m_Phase != DONE && GetPhaseRowCount() <= 0)
+		{
+			m_Phase = (Phase)(m_Phase + 1);
+		}
+	}
+
+	GenerationTask::Phase GenerationTask::GetPhase() const
+	{
+		return m_Phase;
+	}
+
+	bool GenerationTask::IsDone() const
+	{
+		return m_Phase == DONE;
+	}
+
+	bool GenerationTask::HasFailed() const
+	{
+		return m_Phase == FAILED;
+	}
+
+	float GenerationTask::GetProgress() const
+	{
+		// The walk counts for half, each later phase for a sixth
+		switch (m_Phase)
+		{
+		case WALK:
+		{
+			double maxSteps = (double)std::max(m_Generator.GetMaxWalkers(), 1) * (m_Generator.GetMaxPathLength() + 1);
+			return (float)(0.5 * std::min(1.0, m_WalkerSteps / maxSteps));
+		}
+		case TILE:
+		case MAGNIFY:
+		case LAYERS:
+		{
+			int rowCount = std::max(GetPhaseRowCount(), 1);
+			return (float)(0.5 + (m_Phase - TILE + (double)m_NextRow / rowCount) / 6.0);
+		}
+		case DONE:
+			return 1.0f;
+		default:
+			return 0.0f;
+		}
+	}
+
+	WorldGrid& GenerationTask::GetGrid()
+	{
+		return m_Grid;
+	}
+
+	const GenerationStats& GenerationTask::GetStats() const
+	{
+		return m_Stats;
+	}
+
+	unsigned long long GenerationTask::GetWalkerSteps() const
+	{
+		return m_WalkerSteps;
+	}
+
+	unsigned long long GenerationTask::GetCellsCarved() const
+	{
+		return m_CellsCarved;
+	}
+
+	unsigned int GenerationTask::GetSeed() const
+	{
+		return m_Seed;
+	}
+}
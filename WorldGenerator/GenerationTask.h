@@ -0,0 +1,88 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "Generator.h"
+#include <memory>
+
+namespace WorldGenerator
+{
+	// How much work one GenerationTask::Step may do. 0 leaves that limit off
+	struct GenerationBudget
+	{
+		GenerationBudget(unsigned long long steps = 0, double seconds = 0) :
+			Steps(steps),
+			Seconds(seconds)
+		{
+		}
+
+		// Walker steps while walking, rows afterwards
+		unsigned long long Steps;
+		double Seconds;
+	};
+
+	// A GenerateMap call split into pieces, e.g. to spread a large map over several frames.
+	// Each Step continues where the last one stopped, and the finished grid is identical to
+	// the one GenerateMap makes for the same generator, start and seed. The generator must
+	// outlive the task and keep its settings until the task is done
+	class GenerationTask
+	{
+	public:
+		enum Phase
+		{
+			WALK = 0,
+			TILE,
+			MAGNIFY,
+			LAYERS,
+			DONE,
+			FAILED,
+		};
+
+		GenerationTask(const Generator& generator, std::pair<int, int> startPosition, unsigned int seed = 0);
+		GenerationTask(const GenerationTask&) = delete;
+		GenerationTask& operator=(const GenerationTask&) = delete;
+
+		// Works until the budget runs out or the map is done. Returns false once there is nothing left to do
+		bool Step(const GenerationBudget& budget);
+
+		// Runs every remaining step. Returns false when the map could not be generated
+		bool Finish();
+
+		Phase GetPhase()const;
+		bool IsDone()const;
+		bool HasFailed()const;
+
+		// Rough fraction of the work done, from 0 to 1. The walk is measured against the most steps it could take
+		float GetProgress()const;
+
+		// The map, complete once IsDone
+		WorldGrid& GetGrid();
+		const GenerationStats& GetStats()const;
+
+		// Walk counters, kept whether or not WORLDGEN_STATS is on
+		unsigned long long GetWalkerSteps()const;
+		unsigned long long GetCellsCarved()const;
+
+		// The seed in use, which is picked from the clock when 0 was passed in
+		unsigned int GetSeed()const;
+
+	private:
+		// Runs the rows [first, last) of the current phase. Rows are map rows while tiling and grid rows after that
+		void RunRows(int first, int last);
+		int GetPhaseRowCount()const;
+		void NextPhase();
+
+		const Generator& m_Generator;
+		GrowableCanvas m_Canvas;
+		WorldGrid m_Grid;
+		GenerationStats m_Stats;
+		std::unique_ptr<Generator::ResumableWalk> m_Walk;
+		std::pair<int, int> m_RowRange;
+		std::pair<int, int> m_ColumnRange;
+		unsigned int m_Seed;
+		unsigned long long m_WalkerSteps;
+		unsigned long long m_CellsCarved;
+		Phase m_Phase;
+		// Next row of the current phase, counted from the start of the phase
+		int m_NextRow;
+	};
+}
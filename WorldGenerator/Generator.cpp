@@ -1,29 +1,225 @@
 // Created by Eric Marquez. All rights reserved
 
 #include "Generator.h"
+#include "GenerationTask.h"
+#include "Random.h"
+#include "TaskExecutor.h"
+#include <algorithm>
 #include <ctime>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
 
 
 namespace WorldGenerator
 {
-	enum Direction
+	// Side of the canvas a map starts with before walkers push it outwards
+	static const int INITIAL_CANVAS_SIZE = 64;
+
+	// Work done between checks for cancellation by GenerateMapAsync, in walker steps or rows
+	static const unsigned long long ASYNC_SLICE_STEPS = 4096;
+
+	// Runs every GenerateMapAsync call. Started on first use
+	static TaskExecutor& GetAsyncExecutor()
 	{
-		FORWARD = 0,
-		LEFT,
-		RIGHT
-	};
+		static TaskExecutor executor(0);
+		return executor;
+	}
 
-	Generator::Generator(std::string cellSetName)
+	Generator::Generator(std::string cellSetName) :
+		Generator(CellSetLibrary::GetCellSetId(cellSetName))
 	{
-		m_CurrentCellSet = CellSetLibrary::GetCellSet(cellSetName);
+		// Keep the requested name even when no set is registered under it
+		m_CellSetName = cellSetName;
+	}
+
+	Generator::Generator(CellSetId cellSetId)
+	{
+		// Sets never change once registered, so resolving the id once is enough
+		m_CellSetId = cellSetId;
+		m_CurrentCellSet = CellSetLibrary::GetCellSet(cellSetId);
+		m_CellSetName = CellSetLibrary::GetCellSetName(cellSetId);
 		m_MaxWalkers = 4;
 		m_Magnification = std::make_pair(1, 1);
 		m_MaxPathLenth = 20;
 		m_PathDivergenceRate = 30;
 		m_MapDimensions = std::make_pair(100,100);
+		m_WorkerThreads = 0;
+		m_bAutoTiling = true;
+		m_RandomEngine = RandomEngineType::Xoshiro256;
+	}
+
+	bool Generator::GenerateMap(WorldGrid& grid, std::pair<int, int> start, unsigned int seed, GenerationStats* stats) const
+	{
+		GrowableCanvas canvas;
+		return GenerateMap(grid, canvas, start, seed, stats);
+	}
+
+	bool Generator::GenerateMap(WorldGrid& grid, GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, GenerationStats* stats) const
+	{
+		WORLDGEN_STAT(stats, Reset());
+		std::pair<int, int> rowRange;
+		std::pair<int, int> columnRange;
+
+		WORLDGEN_STAT_TIMER(walkTimer, stats);
+		ResetCanvas(canvas, start);
+		if (!Carve(canvas, start, seed, rowRange, columnRange, stats))
+			return false;
+		WORLDGEN_STAT_TIME(stats, WalkSeconds, walkTimer);
+
+		WORLDGEN_STAT_TIMER(tilingTimer, stats);
+		PostProcess(canvas, rowRange, columnRange);
+		WORLDGEN_STAT_TIME(stats, TilingSeconds, tilingTimer);
+
+		WORLDGEN_STAT_TIMER(magnifyTimer, stats);
+		ProcessResults(canvas, grid, rowRange, columnRange);
+		WORLDGEN_STAT_TIME(stats, MagnifySeconds, magnifyTimer);
+
+		return true;
+	}
+
+	bool Generator::GenerateMap(PaletteGrid& grid, std::pair<int, int> start, unsigned int seed, GenerationStats* stats) const
+	{
+		WORLDGEN_STAT(stats, Reset());
+		std::pair<int, int> rowRange;
+		std::pair<int, int> columnRange;
+		GrowableCanvas canvas;
+
+		WORLDGEN_STAT_TIMER(walkTimer, stats);
+		ResetCanvas(canvas, start);
+		if (!Carve(canvas, start, seed, rowRange, columnRange, stats))
+			return false;
+		WORLDGEN_STAT_TIME(stats, WalkSeconds, walkTimer);
+
+		WORLDGEN_STAT_TIMER(tilingTimer, stats);
+		PostProcess(canvas, rowRange, columnRange);
+		WORLDGEN_STAT_TIME(stats, TilingSeconds, tilingTimer);
+
+		WORLDGEN_STAT_TIMER(magnifyTimer, stats);
+		ProcessResults(canvas, grid, rowRange, columnRange);
+		WORLDGEN_STAT_TIME(stats, MagnifySeconds, magnifyTimer);
+
+		return true;
+	}
+
+	bool Generator::GenerateMaps(const std::vector<unsigned int>& seeds, std::vector<WorldGrid>& outputs, std::pair<int, int> start, ThreadPool* pool) const
+	{
+		// Running on the walker pool lets parallel walks nest inline instead of contending for it
+		std::unique_ptr<ThreadPool> ownedPool;
+		if (!pool)
+			pool = m_ThreadPool.get();
+
+		// Unlike the passes that run inline after each map, spreading a batch over the cores is
+		// the point of this call, so it still fans out without a pool. The pool is made once per
+		// batch, which costs little next to generating several maps
+		if (!pool)
+		{
+			ownedPool.reset(new ThreadPool(0));
+			pool = ownedPool.get();
+		}
+
+		outputs.resize(seeds.size());
+
+		// Canvases are reused by every map a thread generates
+		std::vector<GrowableCanvas> canvases(pool->GetThreadCount());
+		std::vector<unsigned char> results(seeds.size(), 0);
+		pool->ParallelFor((unsigned int)seeds.size(), [&](unsigned int index, unsigned int worker)
+		{
+			results[index] = GenerateMap(outputs[index], canvases[worker], start, seeds[index], nullptr);
+		});
+
+		return std::find(results.begin(), results.end(), 0) == results.end();
+	}
+
+	std::future<GenerationResult> Generator::GenerateMapAsync(std::pair<int, int> start, unsigned int seed, ProgressCallback progress, CancellationToken cancellation) const
+	{
+		// Jobs have to be copyable, so the promise is shared with the job
+		std::shared_ptr<std::promise<GenerationResult>> promise = std::make_shared<std::promise<GenerationResult>>();
+		std::future<GenerationResult> future = promise->get_future();
+		Generator generator(*this);
+
+		bool bQueued = GetAsyncExecutor().Submit([generator, start, seed, progress, cancellation, promise]()
+		{
+			// Failures such as running out of memory or a throwing callback are handed to the future
+			try
+			{
+				GenerationResult result;
+				GenerationTask task(generator, start, seed);
+				while (!task.HasFailed() && !cancellation.IsCancelled())
+				{
+					bool bRunning = task.Step(GenerationBudget(ASYNC_SLICE_STEPS));
+					if (progress)
+					{
+						GenerationProgress snapshot;
+						snapshot.WalkerSteps = task.GetWalkerSteps();
+						snapshot.CellsCarved = task.GetCellsCarved();
+						snapshot.Fraction = task.GetProgress();
+						progress(snapshot);
+					}
+
+					if (!bRunning)
+						break;
+				}
+
+				result.bSucceeded = task.IsDone();
+				result.bCancelled = !task.IsDone() && !task.HasFailed();
+				result.Seed = task.GetSeed();
+				result.Stats = task.GetStats();
+				if (result.bSucceeded)
+					std::swap(result.Grid, task.GetGrid());
+
+				promise->set_value(std::move(result));
+			}
+			catch (...)
+			{
+				promise->set_exception(std::current_exception());
+			}
+		});
+
+		// Only happens while the program is exiting
+		if (!bQueued)
+			promise->set_exception(std::make_exception_ptr(std::runtime_error("GenerateMapAsync called after the async executor shut down")));
+
+		return future;
+	}
+
+	bool Generator::CarveMap(PaletteGrid& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange) const
+	{
+		// Cover the whole map up front, reusing the caller's buffer
+		GrowableCanvas fullCanvas;
+		std::swap(fullCanvas.GetGrid(), canvas);
+		fullCanvas.Reset(m_CurrentCellSet, m_MapDimensions, start, std::max(m_MapDimensions.first, m_MapDimensions.second));
+
+		bool bCarved = Carve(fullCanvas, start, seed, rowRange, columnRange, nullptr);
+		std::swap(fullCanvas.GetGrid(), canvas);
+
+		return bCarved;
+	}
+
+	bool Generator::Carve(GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats) const
+	{
+		if (!BeginCarve(canvas, start, seed, rowRange, columnRange, stats))
+			return false;
+
+		// The first walker draws from stream 0 in either walk
+		WithRandomEngine(m_RandomEngine, seed, 0, [&](auto& rng)
+		{
+			if (m_ThreadPool)
+				this->WalkParallel(rng, canvas, start, seed, rowRange, columnRange, stats);
+			else
+				this->WalkSerial(rng, canvas, start, seed, rowRange, columnRange, stats);
+		});
+
+		EndCarve(rowRange, columnRange, stats);
+		return true;
+	}
+
+	void Generator::ResetCanvas(GrowableCanvas& canvas, std::pair<int, int> start) const
+	{
+		canvas.Reset(m_CurrentCellSet, m_MapDimensions, start, INITIAL_CANVAS_SIZE);
 	}
 
-	bool Generator::GenerateMap(WorldGrid& grid, std::pair<int, int> start, unsigned int seed)
+	bool Generator::BeginCarve(GrowableCanvas& canvas, std::pair<int, int> start, unsigned int& seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats) const
 	{
 		if (!m_CurrentCellSet)
 			return false;
@@ -32,69 +228,350 @@ namespace WorldGenerator
 		if(m_MapDimensions.first < 3 && m_MapDimensions.second < 3)
 			return false;
 
+		// Walkers look their moves up by position, so they have to start on the map
+		if (start.first < 0 || start.first >= m_MapDimensions.first || start.second < 0 || start.second >= m_MapDimensions.second)
+			return false;
+
 		// Setup grid
-		grid.resize(m_MapDimensions.first);
-		for (int x = 0; x < m_MapDimensions.first; x++)
+		const unsigned char ground = CellSet::GetPaletteIndex(CellType::Ground);
+		canvas.Reserve(start, 1);
+		canvas.At(start.first, start.second) = ground;
+		canvas.At(start.first + 1, start.second) = ground;
+		canvas.At(start.first - 1, start.second) = ground;
+		WORLDGEN_STAT(stats, CellsCarved += 3);
+
+		// Set seed if not set
+		seed = (seed) ? seed : (unsigned)time(0);
+
+		// Set deault min and max
+		rowRange = std::make_pair(start.first, start.first);
+		columnRange = std::make_pair(start.second, start.second);
+		return true;
+	}
+
+	void Generator::EndCarve(std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats) const
+	{
+		// Add padding to map
+		rowRange.first = clamp(rowRange.first - 1, 0, rowRange.first);
+		rowRange.second = clamp(rowRange.second + 1, rowRange.second, m_MapDimensions.first - 1);
+		columnRange.first = clamp(columnRange.first - 1, 0, columnRange.first);
+		columnRange.second = clamp(columnRange.second + 1, columnRange.second, m_MapDimensions.second - 1);
+
+		WORLDGEN_STAT(stats, RowRange = rowRange);
+		WORLDGEN_STAT(stats, ColumnRange = columnRange);
+	}
+
+	// Walker loop of the serial walk, split so it can stop after any step. With per-walker
+	// streams every walker draws from its own stream and spawns are settled at the end of
+	// each pass, which reproduces WalkParallel on a single thread
+	template<typename Engine>
+	class Generator::SteppedWalk : public Generator::ResumableWalk
+	{
+	public:
+		SteppedWalk(const Generator& generator, const Engine& rng, bool bPerWalkerStreams, GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed,
+			std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats) :
+			m_Generator(generator),
+			m_Canvas(canvas),
+			m_RowRange(rowRange),
+			m_ColumnRange(columnRange),
+			m_Stats(stats),
+			m_Seed(seed),
+			m_bPerWalkerStreams(bPerWalkerStreams),
+			m_SpawnedCount(1),
+			m_PassSize(0),
+			m_NextIndex(0),
+			m_CellsCarved(3)
 		{
-			grid.at(x).resize(m_MapDimensions.second);
+			m_Walkers.Reset(generator.m_MapDimensions, generator.m_MaxPathLenth);
+			m_Walkers.Spawn(start, std::make_pair(0, 1), 0);
+			m_Streams.push_back(rng);
+			WORLDGEN_STAT(stats, WalkersSpawned++);
 		}
 
-		std::vector<Walker*> walkers;
-		walkers.emplace_back(new Walker(grid, m_MaxPathLenth, m_MapDimensions, start, std::make_pair(0, 1), m_CurrentCellSet));
-		grid[start.first][start.second] = m_CurrentCellSet->GetCell(CellType::Ground);
-		grid[start.first + 1][start.second] = m_CurrentCellSet->GetCell(CellType::Ground);
-		grid[start.first - 1][start.second] = m_CurrentCellSet->GetCell(CellType::Ground);
+		unsigned long long Advance(unsigned long long maxSteps) override
+		{
+			unsigned long long steps = 0;
+			while (steps < maxSteps && !m_Walkers.empty())
+			{
+				// Walkers spawned during a pass take their first step in the next one
+				if (m_NextIndex == 0)
+				{
+					m_PassSize = m_Walkers.size();
+					m_Walkers.UpdateMoves(0, m_PassSize);
+					m_SpawnRolls.resize(m_PassSize);
+				}
 
-		// Set seed if not set
-		seed = (seed) ? seed : (unsigned)time(0);
+				const unsigned int last = (unsigned int)std::min<unsigned long long>(m_PassSize, m_NextIndex + (maxSteps - steps));
+				steps += last - m_NextIndex;
+				if (m_bPerWalkerStreams)
+				{
+					for (; m_NextIndex < last; m_NextIndex++)
+						StepOwnStream(m_NextIndex);
+				}
+				else
+				{
+					for (; m_NextIndex < last; m_NextIndex++)
+						StepSharedStream(m_NextIndex);
+				}
+
+				if (m_NextIndex == m_PassSize)
+				{
+					if (m_bPerWalkerStreams)
+						SettleSpawns();
 
-		std::mt19937 rng(seed);
-		std::uniform_int_distribution<std::mt19937::result_type> createWalkerRoll(0,1);
+					m_Walkers.Compact(m_PassSize);
+					m_NextIndex = 0;
+				}
+			}
 
-		// Set deault min and max
-		std::pair<int, int> rowRange = std::make_pair(start.first, start.first);
-		std::pair<int, int> columnRange = std::make_pair(start.second, start.second);
+			return steps;
+		}
+
+		unsigned long long GetCellsCarved() const override
+		{
+			return m_CellsCarved;
+		}
 
-		bool bRunning = true;
-		int inactiveCount = 0;
-		while (bRunning)
+	private:
+		void StepSharedStream(unsigned int index)
 		{
-			unsigned int size = (unsigned int) walkers.size();
-			for (unsigned int index = 0; index < size; index++)
+			Engine& rng = m_Streams[0];
+			if (!m_Walkers.Step(index, rng, m_Generator.m_PathDivergenceRate, m_Stats))
 			{
-				Walker* walker = walkers[index];
+				WORLDGEN_STAT(m_Stats, WalkersRetired++);
+				return;
+			}
+
+			CarveAround(index);
+			if (m_Generator.m_MaxWalkers > m_SpawnedCount && UniformBool(rng))
+			{
+				m_Walkers.Spawn(m_Walkers.GetLocation(index), m_Walkers.GetDirection(index));
+				m_SpawnedCount++;
+				WORLDGEN_STAT(m_Stats, WalkersSpawned++);
+			}
+		}
+
+		void StepOwnStream(unsigned int index)
+		{
+			Engine& stream = m_Streams[m_Walkers.GetId(index)];
+			if (!m_Walkers.Step(index, stream, m_Generator.m_PathDivergenceRate, m_Stats))
+				return;
+
+			m_SpawnRolls[index] = UniformBool(stream);
+			CarveAround(index);
+		}
 
-				if (!walker)
+		// Retires and spawns in walker order, the same way WalkParallel does between passes
+		void SettleSpawns()
+		{
+			for (unsigned int index = 0; index < m_PassSize; index++)
+			{
+				if (!m_Walkers.IsActive(index))
+				{
+					WORLDGEN_STAT(m_Stats, WalkersRetired++);
 					continue;
+				}
 
-				if (!walker->Update(rng, rowRange, columnRange, m_PathDivergenceRate))
+				if (m_Generator.m_MaxWalkers > m_SpawnedCount && m_SpawnRolls[index])
 				{
-					inactiveCount++;
-					delete walker;
-					walkers[index] = nullptr;
+					m_Walkers.Spawn(m_Walkers.GetLocation(index), m_Walkers.GetDirection(index), m_SpawnedCount);
+					m_Streams.push_back(MakeEngine<Engine>(m_Seed, m_SpawnedCount));
+					m_SpawnedCount++;
+					WORLDGEN_STAT(m_Stats, WalkersSpawned++);
 				}
-				else
+			}
+		}
+
+		// Fills in path, skipping sides that hang off the map
+		void CarveAround(unsigned int index)
+		{
+			const unsigned char ground = CellSet::GetPaletteIndex(CellType::Ground);
+			std::pair<int, int> location = m_Walkers.GetLocation(index);
+			std::pair<int, int> cells[3];
+			m_Walkers.GetCarvedCells(index, cells);
+			m_Canvas.Reserve(location, 1);
+			for (const auto& cell : cells)
+			{
+				if (!m_Canvas.IsOnMap(cell.first, cell.second))
+					continue;
+
+				unsigned char& target = m_Canvas.At(cell.first, cell.second);
+				m_CellsCarved += (target != ground);
+				WORLDGEN_STAT(m_Stats, CellsCarved += (target != ground));
+				WORLDGEN_STAT(m_Stats, CellsRecarved += (target == ground));
+				target = ground;
+			}
+
+			m_RowRange.first = std::min(m_RowRange.first, location.first);
+			m_RowRange.second = std::max(m_RowRange.second, location.first);
+			m_ColumnRange.first = std::min(m_ColumnRange.first, location.second);
+			m_ColumnRange.second = std::max(m_ColumnRange.second, location.second);
+		}
+
+		const Generator& m_Generator;
+		GrowableCanvas& m_Canvas;
+		std::pair<int, int>& m_RowRange;
+		std::pair<int, int>& m_ColumnRange;
+		GenerationStats* m_Stats;
+		unsigned int m_Seed;
+		bool m_bPerWalkerStreams;
+		WalkerSet m_Walkers;
+		// Stream 0 is shared by every walker unless each walker has its own
+		std::vector<Engine> m_Streams;
+		std::vector<unsigned char> m_SpawnRolls;
+		unsigned int m_SpawnedCount;
+		unsigned int m_PassSize;
+		unsigned int m_NextIndex;
+		// Starts with the three cells BeginCarve carves
+		unsigned long long m_CellsCarved;
+	};
+
+	std::unique_ptr<Generator::ResumableWalk> Generator::StartWalk(GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats) const
+	{
+		// A worker pool means Carve would take the parallel walk, so give every walker its own stream like it does
+		std::unique_ptr<ResumableWalk> walk;
+		WithRandomEngine(m_RandomEngine, seed, 0, [&](auto& rng)
+		{
+			typedef typename std::decay<decltype(rng)>::type Engine;
+			walk.reset(new SteppedWalk<Engine>(*this, rng, m_ThreadPool != nullptr, canvas, start, seed, rowRange, columnRange, stats));
+		});
+
+		return walk;
+	}
+
+	template<typename Engine>
+	void Generator::WalkSerial(Engine& rng, GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats) const
+	{
+		SteppedWalk<Engine> walk(*this, rng, false, canvas, start, seed, rowRange, columnRange, stats);
+		walk.Advance(~0ull);
+	}
+
+	template<typename Engine>
+	void Generator::WalkParallel(Engine& rng, GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats) const
+	{
+		// Walkers are numbered in spawn order and each one draws from its own stream, so a
+		// walker's path does not depend on which thread steps it
+		WalkerSet walkers;
+		std::vector<Engine> streams;
+		streams.reserve(std::max(m_MaxWalkers, 1u));
+		walkers.Reset(m_MapDimensions, m_MaxPathLenth);
+		walkers.Spawn(start, std::make_pair(0, 1), 0);
+		streams.push_back(rng);
+		WORLDGEN_STAT(stats, WalkersSpawned++);
+
+		// Each thread keeps its own carved bounds and buckets carved cells by the row band
+		// that owns them, so stamping the grid needs no synchronization
+		struct WorkerState
+		{
+			std::vector<std::vector<std::pair<int, int>>> Bands;
+			std::pair<int, int> RowRange;
+			std::pair<int, int> ColumnRange;
+			GenerationStats Stats;
+		};
+
+		const unsigned int threadCount = m_ThreadPool->GetThreadCount();
+		const int bandRows = (m_MapDimensions.first + threadCount - 1) / threadCount;
+
+		std::vector<WorkerState> workers(threadCount);
+		for (auto& worker : workers)
+		{
+			worker.Bands.resize(threadCount);
+			worker.RowRange = rowRange;
+			worker.ColumnRange = columnRange;
+		}
+
+		const unsigned int blockSize = 64;
+		std::vector<unsigned char> spawnRolls;
+		while (!walkers.empty())
+		{
+			const unsigned int count = walkers.size();
+			spawnRolls.resize(count);
+			unsigned int blockCount = (count + blockSize - 1) / blockSize;
+			m_ThreadPool->ParallelFor(blockCount, [&](unsigned int block, unsigned int workerIndex)
+			{
+				WorkerState& worker = workers[workerIndex];
+				GenerationStats* workerStats = stats ? &worker.Stats : nullptr;
+				unsigned int first = block * blockSize;
+				unsigned int last = std::min(first + blockSize, count);
+				walkers.UpdateMoves(first, last);
+				for (unsigned int index = first; index < last; index++)
 				{
-					if (m_MaxWalkers > walkers.size() && createWalkerRoll(rng))
+					Engine& stream = streams[walkers.GetId(index)];
+					if (!walkers.Step(index, stream, m_PathDivergenceRate, workerStats))
+						continue;
+
+					spawnRolls[index] = UniformBool(stream);
+
+					std::pair<int, int> cells[3];
+					walkers.GetCarvedCells(index, cells);
+					for (const auto& cell : cells)
 					{
-						walkers.emplace_back(new Walker(grid, m_MaxPathLenth, m_MapDimensions, walker->GetLocaton(), walker->GetDirection(), m_CurrentCellSet));
+						if (canvas.IsOnMap(cell.first, cell.second))
+							worker.Bands[cell.first / bandRows].push_back(cell);
 					}
+
+					std::pair<int, int> location = walkers.GetLocation(index);
+					worker.RowRange.first = std::min(worker.RowRange.first, location.first);
+					worker.RowRange.second = std::max(worker.RowRange.second, location.first);
+					worker.ColumnRange.first = std::min(worker.ColumnRange.first, location.second);
+					worker.ColumnRange.second = std::max(worker.ColumnRange.second, location.second);
+				}
+			});
+
+			// Retire and spawn in walker order so the walker count cap is applied the same way every run
+			for (unsigned int index = 0; index < count; index++)
+			{
+				if (!walkers.IsActive(index))
+				{
+					WORLDGEN_STAT(stats, WalkersRetired++);
+					continue;
+				}
+
+				if (m_MaxWalkers > streams.size() && spawnRolls[index])
+				{
+					walkers.Spawn(walkers.GetLocation(index), walkers.GetDirection(index), (unsigned int)streams.size());
+					streams.push_back(MakeEngine<Engine>(seed, streams.size()));
+					WORLDGEN_STAT(stats, WalkersSpawned++);
 				}
 			}
 
-			if (inactiveCount == walkers.size())
-				bRunning = false;
+			walkers.Compact(count);
 		}
 
-		// Add padding to map
-		rowRange.first = clamp(rowRange.first - 1, 0, rowRange.first);
-		rowRange.second = clamp(rowRange.second + 1, rowRange.second, m_MapDimensions.first - 1);
-		columnRange.first = clamp(columnRange.first - 1, 0, columnRange.first);
-		columnRange.second = clamp(columnRange.second + 1, columnRange.second, m_MapDimensions.second - 1);
+		for (const auto& worker : workers)
+		{
+			rowRange.first = std::min(rowRange.first, worker.RowRange.first);
+			rowRange.second = std::max(rowRange.second, worker.RowRange.second);
+			columnRange.first = std::min(columnRange.first, worker.ColumnRange.first);
+			columnRange.second = std::max(columnRange.second, worker.ColumnRange.second);
+			WORLDGEN_STAT(stats, Merge(worker.Stats));
+		}
 
-		ProcessResults(grid, rowRange, columnRange);
+		// The carved bounds are known now, so the canvas only has to grow once
+		canvas.Reserve(rowRange.first - 1, rowRange.second + 1, columnRange.first - 1, columnRange.second + 1);
 
-		return true;
+		// Each band is stamped by a single thread
+		const unsigned char ground = CellSet::GetPaletteIndex(CellType::Ground);
+		std::vector<GenerationStats> bandStats(stats ? threadCount : 0);
+		m_ThreadPool->ParallelFor(threadCount, [&](unsigned int band, unsigned int)
+		{
+			GenerationStats* bandStat = stats ? &bandStats[band] : nullptr;
+			for (const auto& worker : workers)
+			{
+				for (const auto& cell : worker.Bands[band])
+				{
+					unsigned char& target = canvas.At(cell.first, cell.second);
+					WORLDGEN_STAT(bandStat, CellsCarved += (target != ground));
+					WORLDGEN_STAT(bandStat, CellsRecarved += (target == ground));
+					target = ground;
+				}
+			}
+		});
+
+		for (size_t band = 0; band < bandStats.size(); band++)
+		{
+			WORLDGEN_STAT(stats, Merge(bandStats[band]));
+		}
 	}
 
 	void Generator::SetMapSize(int rows, int columns)
@@ -122,6 +599,40 @@ namespace WorldGenerator
 		m_Magnification = std::make_pair(x, y);
 	}
 
+	void Generator::SetAutoTiling(bool bEnabled)
+	{
+		m_bAutoTiling = bEnabled;
+	}
+
+	void Generator::SetWorkerThreads(unsigned int count)
+	{
+		m_WorkerThreads = count;
+		if (count)
+			m_ThreadPool = std::make_shared<ThreadPool>(count);
+		else
+			m_ThreadPool.reset();
+	}
+
+	void Generator::SetRandomEngine(RandomEngineType engine)
+	{
+		m_RandomEngine = engine;
+	}
+
+	const CellSet* Generator::GetCellSet() const
+	{
+		return m_CurrentCellSet;
+	}
+
+	const std::string& Generator::GetCellSetName() const
+	{
+		return m_CellSetName;
+	}
+
+	CellSetId Generator::GetCellSetId() const
+	{
+		return m_CellSetId;
+	}
+
 	std::pair<int, int> Generator::GetMagnification() const
 	{
 		return m_Magnification;
@@ -152,186 +663,54 @@ namespace WorldGenerator
 		return m_MapDimensions.first;
 	}
 
-	void Generator::Duplicate(WorldGrid& grid, Cell cell, std::pair<int, int> count, std::pair<int, int> originalLocation)
+	unsigned int Generator::GetWorkerThreads() const
 	{
-		for (int x = 0; x < count.first; x++)
-		{
-			for (int y = 0; y < count.second; y++)
-			{
-				grid[(originalLocation.first * count.first) + x][((size_t)originalLocation.second * count.second) + y] = cell;
-			}
-		}
+		return m_WorkerThreads;
 	}
 
-	void Generator::ProcessResults(WorldGrid& grid, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange)
+	RandomEngineType Generator::GetRandomEngine() const
 	{
-		WorldGrid newGrid;
-		newGrid.resize((rowRange.second - rowRange.first) * m_Magnification.first);
-		for (unsigned int x = 0; x < newGrid.RowCount(); x++)
-		{
-			newGrid.at(x).resize(((size_t)columnRange.second - columnRange.first) * m_Magnification.second);
-		}
-
-		int rowOffset = 0;
-		for (int x = rowRange.first; x < rowRange.second; x++)
-		{
-			int columnOffset = 0;
-			for (int y = columnRange.first; y < columnRange.second; y++)
-			{
-				Duplicate(newGrid, grid[x][y], m_Magnification, std::pair<int, int>(x - rowRange.first, y - columnRange.first));
-			}
-		}
-
-		grid = newGrid;
+		return m_RandomEngine;
 	}
 
-	int Generator::clamp(int num, int min, int max)
+	bool Generator::IsAutoTiling() const
 	{
-		return std::max(min, std::min(num, max));
-	}
-
-	Generator::Walker::Walker(WorldGrid& grid, int maxLength, std::pair<int, int> dimensions, std::pair<int, int> location, std::pair<int, int> direction, CellSet* cellSet)
-	{
-		m_CellSet = cellSet;
-		m_MaxLength = maxLength;
-		m_Grid = &grid;
-		m_Location = location;
-		m_Dimensions = dimensions;
-		m_CurrentPathLength = 0;
-		m_Forward = direction;
+		return m_bAutoTiling;
 	}
 
-	bool Generator::Walker::Update(std::mt19937& rng, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, int strayPercentage)
+	void Generator::PostProcess(GrowableCanvas& canvas, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange) const
 	{
-		if (!m_Grid)
-			return false;
-
-		if(m_CurrentPathLength > m_MaxLength)
-			return false;
-
-		bool bFrontBlocked = false;
-		auto directions = GetAvailableDirections(bFrontBlocked);
-		if (directions.size() <= 0)
-			return false;
-
-		// Roll direction
-		std::uniform_int_distribution<std::mt19937::result_type> changeDirectionRoll(0, 100);
-		if (bFrontBlocked || (directions.size() > 1 && (unsigned int)strayPercentage >= changeDirectionRoll(rng)))
+		if (m_bAutoTiling)
 		{
-			int offset = bFrontBlocked ? 0 : 1;
-			std::uniform_int_distribution<std::mt19937::result_type> moveWalkerRoll(offset, (int)directions.size() - 1);
-			int dirIndex = moveWalkerRoll(rng);
-			auto direction = GetDirectionVector(directions[dirIndex]);
-			m_Forward = direction;
+			std::pair<int, int> origin = canvas.GetOrigin();
+			int elevation = m_CurrentCellSet->GetCell(CellType::Ground).Depth;
+			AutoTiler::Apply(canvas.GetGrid(), std::make_pair(rowRange.first - origin.first, rowRange.second - origin.first), std::make_pair(columnRange.first - origin.second, columnRange.second - origin.second), elevation);
 		}
-
-		// move walker
-		m_CurrentPathLength++;
-		m_Location.first += m_Forward.first;
-		m_Location.second += m_Forward.second;
-
-		// Fill in path
-		m_Grid->at(m_Location.first).at(m_Location.second) = m_CellSet->GetCell(CellType::Ground);
-		m_Grid->at(m_Location.first - m_Forward.second).at((size_t)m_Location.second - m_Forward.first) = m_CellSet->GetCell(CellType::Ground);
-		m_Grid->at(m_Location.first + m_Forward.second).at((size_t)m_Location.second + m_Forward.first) = m_CellSet->GetCell(CellType::Ground);
-
-		// Record min and max
-		rowRange.first = (m_Location.first < rowRange.first) ? m_Location.first : rowRange.first;
-		rowRange.second = (m_Location.first > rowRange.second) ? m_Location.first : rowRange.second;
-		columnRange.first = (m_Location.second < columnRange.first) ? m_Location.second : columnRange.first;
-		columnRange.second = (m_Location.second > columnRange.second) ? m_Location.second : columnRange.second;
-
-		return true;
 	}
 
-	std::pair<int, int> Generator::Walker::GetLocaton() const
+	MagnifiedView<unsigned char> Generator::GetResultView(const GrowableCanvas& canvas, const std::pair<int, int>& rowRange, const std::pair<int, int>& columnRange) const
 	{
-		return m_Location;
+		// Cropping is only an offset into the canvas
+		std::pair<int, int> origin = canvas.GetOrigin();
+		return MagnifiedView<unsigned char>(canvas.GetGrid(), std::make_pair(rowRange.first - origin.first, rowRange.second - origin.first), std::make_pair(columnRange.first - origin.second, columnRange.second - origin.second), m_Magnification);
 	}
 
-	std::pair<int, int> Generator::Walker::GetDirection() const
+	void Generator::ProcessResults(const GrowableCanvas& canvas, WorldGrid& grid, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange) const
 	{
-		return m_Forward;
+		// Decode straight into the magnified grid
+		const Cell* palette = canvas.GetGrid().GetCellSet()->GetPalette();
+		GetResultView(canvas, rowRange, columnRange).Materialize(grid, [palette](unsigned char index) { return palette[index]; });
+		grid.RebuildLayers();
 	}
 
-	std::vector<unsigned int> Generator::Walker::GetAvailableDirections(bool& frontBlocked)
+	void Generator::ProcessResults(const GrowableCanvas& canvas, PaletteGrid& grid, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange) const
 	{
-		std::vector<unsigned int> directions;
-
-		bool xForward = (m_Location.first + m_Forward.first >= 0 && m_Location.first + m_Forward.first < m_Dimensions.first);
-		bool yForward = (m_Location.second + m_Forward.second >= 0 && m_Location.second + m_Forward.second < m_Dimensions.second);
-
-		if (xForward && yForward)
-		{
-			bool xBackward = (m_Location.first - m_Forward.first >= 0 && m_Location.first - m_Forward.first < m_Dimensions.first);
-			bool yBackward = (m_Location.second - m_Forward.second >= 0 && m_Location.second - m_Forward.second < m_Dimensions.second);
-			directions.push_back(FORWARD);
-
-			if (xBackward && yBackward)
-			{
-				bool xRight = (m_Location.first + m_Forward.second >= 0 && m_Location.first + m_Forward.second < m_Dimensions.first);
-				bool yRight = (m_Location.second + m_Forward.first >= 0 && m_Location.second + m_Forward.first < m_Dimensions.second);
-				if (xRight && yRight)
-				{
-					directions.push_back(RIGHT);
-				}
-
-				bool xLeft = (m_Location.first - m_Forward.second >= 0 && m_Location.first - m_Forward.second < m_Dimensions.first);
-				bool yLeft = (m_Location.second - m_Forward.first >= 0 && m_Location.second - m_Forward.first < m_Dimensions.second);
-
-				if (xForward && yForward)
-				{
-					directions.push_back(LEFT);
-				}
-			}
-		}
-		else
-		{
-			int options = 0;
-			std::pair<int, int> tempLocation = std::make_pair(m_Location.first - m_Forward.first, m_Location.second - m_Forward.second);
-			bool xBackward = (tempLocation.first - m_Forward.first >= 0 && tempLocation.first - m_Forward.first < m_Dimensions.first);
-			bool yBackward = (tempLocation.second - m_Forward.second >= 0 && tempLocation.second - m_Forward.second < m_Dimensions.second);
-
-			if (xBackward && yBackward)
-			{
-				bool xRight = (tempLocation.first + m_Forward.second >= 0 && tempLocation.first + m_Forward.second < m_Dimensions.first);
-				bool yRight = (tempLocation.second + m_Forward.first >= 0 && tempLocation.second + m_Forward.first < m_Dimensions.second);
-				if (xRight && yRight)
-				{
-					directions.push_back(RIGHT);
-					options++;
-				}
-
-				bool xLeft = (tempLocation.first - m_Forward.second >= 0 && tempLocation.first - m_Forward.second < m_Dimensions.first);
-				bool yLeft = (tempLocation.second - m_Forward.first >= 0 && tempLocation.second - m_Forward.first < m_Dimensions.second);
-
-				if (xForward && yForward)
-				{
-					directions.push_back(LEFT);
-					options++;
-				}
-
-				if (options > 0)
-				{
-					frontBlocked = true;
-					m_Location = tempLocation;
-				}
-			}
-		}
-
-		return directions;
+		grid.SetCellSet(canvas.GetGrid().GetCellSet());
+		GetResultView(canvas, rowRange, columnRange).Materialize(grid);
 	}
 
-	std::pair<int, int> Generator::Walker::GetDirectionVector(unsigned int direction)
+	int Generator::clamp(int num, int min, int max) const
 	{
-		switch (direction)
-		{
-		case WorldGenerator::LEFT:
-			return std::pair<int, int>(-m_Forward.second, -m_Forward.first);
-		case WorldGenerator::RIGHT:
-			return std::pair<int, int>(m_Forward.second, m_Forward.first);
-		}
-
-		return m_Forward;
+		return std::max(min, std::min(num, max));
 	}
 }
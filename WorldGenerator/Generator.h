@@ -2,7 +2,16 @@
 // Created by Eric Marquez. All rights reserved
 
 #include "LandmarkTemplate.h"
-#include <random>
+#include "GrowableCanvas.h"
+#include "AutoTiler.h"
+#include "MagnifiedView.h"
+#include "ThreadPool.h"
+#include "WalkerSet.h"
+#include "GenerationStats.h"
+#include "Random.h"
+#include "AsyncGeneration.h"
+#include <future>
+#include <memory>
 
 namespace WorldGenerator
 {
@@ -10,8 +19,32 @@ namespace WorldGenerator
 	{
 	public:
 		Generator(std::string cellSetName);
+		Generator(CellSetId cellSetId);
 
-		bool GenerateMap(WorldGrid& grid, std::pair<int, int> startPosition, unsigned int seed = 0);
+		// Generation only reads the generator's settings, so one generator may be shared by many threads.
+		// When stats is set it is reset and filled with counters describing the run
+		bool GenerateMap(WorldGrid& grid, std::pair<int, int> startPosition, unsigned int seed = 0, GenerationStats* stats = nullptr)const;
+
+		// Same as above but keeps the result as palette indices into the generator's cell set
+		bool GenerateMap(PaletteGrid& grid, std::pair<int, int> startPosition, unsigned int seed = 0, GenerationStats* stats = nullptr)const;
+
+		// Generates one map per seed across a thread pool. outputs[i] always holds the map for seeds[i].
+		// Uses the worker thread pool when one is set, otherwise a pool with a thread per core made
+		// for the batch. Pass a pool to reuse threads across batches
+		bool GenerateMaps(const std::vector<unsigned int>& seeds, std::vector<WorldGrid>& outputs, std::pair<int, int> startPosition, ThreadPool* pool = nullptr)const;
+
+		// Generates a map on background threads shared by every generator and returns straight away.
+		// The settings are copied, so the generator may change or go away before the map is done.
+		// progress is called from the background thread every few thousand steps. Cancelling stops
+		// the run within that many steps and leaves the result's grid empty. A finished map is the
+		// one GenerateMap makes for the same seed. Anything thrown while generating, including by
+		// progress, is rethrown from the future's get
+		std::future<GenerationResult> GenerateMapAsync(std::pair<int, int> startPosition, unsigned int seed = 0,
+			ProgressCallback progress = ProgressCallback(), CancellationToken cancellation = CancellationToken())const;
+
+		// Runs the walk into a map sized canvas without cropping or magnifying it.
+		// The ranges receive the padded bounds of the carved area
+		bool CarveMap(PaletteGrid& canvas, std::pair<int, int> startPosition, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange)const;
 
 		void SetMapSize(int rows, int columns);
 		void SetMaxPathLength(int length);
@@ -19,46 +52,81 @@ namespace WorldGenerator
 		void SetPathDivergencePercent(int percent);
 		void SetMagnification(unsigned int x, unsigned int y);
 
+		// Borders carved ground with wall cells, or cliff cells when the set's ground has depth. On by default
+		void SetAutoTiling(bool bEnabled);
+
+		// Steps walkers on count threads. Each walker then draws from its own stream derived from
+		// the seed, so any non-zero count produces the same map. Zero keeps the single stream walk
+		void SetWorkerThreads(unsigned int count);
+
+		// Selects the engine walkers draw from. Maps are only reproducible with the same engine
+		void SetRandomEngine(RandomEngineType engine);
+
+		const CellSet* GetCellSet()const;
+		const std::string& GetCellSetName()const;
+		CellSetId GetCellSetId()const;
 		std::pair<int, int> GetMagnification()const;
 		int GetPathDivergencePercent()const;
 		int GetMaxWalkers()const;
 		int GetMaxPathLength()const;
 		int GetMapColumns()const;
 		int GetMapRows()const;
+		unsigned int GetWorkerThreads()const;
+		RandomEngineType GetRandomEngine()const;
+		bool IsAutoTiling()const;
 
 	private:
-		void Duplicate(WorldGrid& grid, Cell cell, std::pair<int, int> count, std::pair<int, int> originalLocation);
-		void ProcessResults(WorldGrid& grid, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange);
-		int clamp(int num, int min, int max);
+		friend class GenerationTask;
 
-		class Walker
+		// A walk that can stop after any walker step and carry on from there later
+		class ResumableWalk
 		{
 		public:
-			Walker(WorldGrid& grid, int maxLength, std::pair<int, int> dimensions, std::pair<int, int> location, std::pair<int, int> direction, CellSet* cellSetName);
-			bool Update(std::mt19937& rng, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, int StrayPercentage);
-			std::pair<int, int> GetLocaton()const;
-			std::pair<int, int> GetDirection()const;
-
-		private:
-			std::vector<unsigned int> GetAvailableDirections(bool& frontBlocked);
-			std::pair<int, int> GetDirectionVector(unsigned int direction);
-
-			int m_MaxLength;
-			int m_CurrentPathLength;
-			WorldGrid* m_Grid;
-			CellSet* m_CellSet;
-			std::pair<int, int> m_Forward;
-			std::pair<int, int> m_Location;
-			std::pair<int, int> m_Dimensions;
+			virtual ~ResumableWalk() = default;
+
+			// Steps walkers up to maxSteps times and returns the steps taken, which is fewer
+			// than maxSteps only once the walk has finished
+			virtual unsigned long long Advance(unsigned long long maxSteps) = 0;
 
+			// Cells turned to ground so far, counting the start cells, whether or not stats are collected
+			virtual unsigned long long GetCellsCarved()const = 0;
 		};
 
+		template<typename Engine>
+		class SteppedWalk;
+
+		bool GenerateMap(WorldGrid& grid, GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, GenerationStats* stats)const;
+		bool Carve(GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats)const;
+		void ResetCanvas(GrowableCanvas& canvas, std::pair<int, int> start)const;
+
+		// Checks the settings, seeds the start cells and resolves a zero seed. Carve is BeginCarve, a walk, then EndCarve
+		bool BeginCarve(GrowableCanvas& canvas, std::pair<int, int> start, unsigned int& seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats)const;
+		void EndCarve(std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats)const;
+
+		// Walk with the same result as the one Carve would run, but driven by the caller
+		std::unique_ptr<ResumableWalk> StartWalk(GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats)const;
+		template<typename Engine>
+		void WalkSerial(Engine& rng, GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats)const;
+		template<typename Engine>
+		void WalkParallel(Engine& rng, GrowableCanvas& canvas, std::pair<int, int> start, unsigned int seed, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange, GenerationStats* stats)const;
+		void PostProcess(GrowableCanvas& canvas, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange)const;
+		MagnifiedView<unsigned char> GetResultView(const GrowableCanvas& canvas, const std::pair<int, int>& rowRange, const std::pair<int, int>& columnRange)const;
+		void ProcessResults(const GrowableCanvas& canvas, WorldGrid& grid, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange)const;
+		void ProcessResults(const GrowableCanvas& canvas, PaletteGrid& grid, std::pair<int, int>& rowRange, std::pair<int, int>& columnRange)const;
+		int clamp(int num, int min, int max)const;
+
 		unsigned int m_PathDivergenceRate;
 		unsigned int m_MaxWalkers;
 		unsigned int m_MaxPathLenth;
-		CellSet* m_CurrentCellSet;
+		const CellSet* m_CurrentCellSet;
+		CellSetId m_CellSetId;
+		std::string m_CellSetName;
 		std::pair<int, int> m_MapDimensions;
 		std::pair<int, int> m_Magnification;
+		unsigned int m_WorkerThreads;
+		bool m_bAutoTiling;
+		RandomEngineType m_RandomEngine;
+		std::shared_ptr<ThreadPool> m_ThreadPool;
 	};
 }
 
@@ -0,0 +1,132 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "PaletteGrid.h"
+
+namespace WorldGenerator
+{
+	// Palette canvas that covers a window of the map and grows as walkers approach its edges.
+	// Cells are addressed in map coordinates. Each growth at least doubles the window on the
+	// sides that need it, so the cost of growing stays proportional to the final area.
+	class GrowableCanvas
+	{
+	public:
+		GrowableCanvas()
+		{
+			m_Origin = std::make_pair(0, 0);
+			m_MapDimensions = std::make_pair(0, 0);
+		}
+
+		// Starts an empty window of at most initialSize cells per side, centered on center
+		void Reset(const CellSet* cellSet, std::pair<int, int> mapDimensions, std::pair<int, int> center, int initialSize)
+		{
+			m_MapDimensions = mapDimensions;
+			int rows = std::min(initialSize, mapDimensions.first);
+			int columns = std::min(initialSize, mapDimensions.second);
+			m_Origin.first = std::max(0, std::min(center.first - rows / 2, mapDimensions.first - rows));
+			m_Origin.second = std::max(0, std::min(center.second - columns / 2, mapDimensions.second - columns));
+
+			m_Grid.SetCellSet(cellSet);
+			m_Grid.assign(rows, columns);
+		}
+
+		// Makes sure every map cell within margin of location is on the canvas
+		void Reserve(std::pair<int, int> location, int margin)
+		{
+			Reserve(location.first - margin, location.first + margin, location.second - margin, location.second + margin);
+		}
+
+		// Makes sure the inclusive rectangle, clipped to the map, is on the canvas
+		void Reserve(int rowFirst, int rowLast, int columnFirst, int columnLast)
+		{
+			rowFirst = std::max(rowFirst, 0);
+			columnFirst = std::max(columnFirst, 0);
+			rowLast = std::min(rowLast, m_MapDimensions.first - 1);
+			columnLast = std::min(columnLast, m_MapDimensions.second - 1);
+
+			if (rowFirst >= m_Origin.first && columnFirst >= m_Origin.second &&
+				rowLast < m_Origin.first + (int)m_Grid.RowCount() && columnLast < m_Origin.second + (int)m_Grid.ColumnCount())
+				return;
+
+			Grow(rowFirst, rowLast, columnFirst, columnLast);
+		}
+
+		bool IsOnMap(int row, int column)const
+		{
+			return row >= 0 && row < m_MapDimensions.first && column >= 0 && column < m_MapDimensions.second;
+		}
+
+		bool Contains(int row, int column)const
+		{
+			return row >= m_Origin.first && row < m_Origin.first + (int)m_Grid.RowCount() &&
+				column >= m_Origin.second && column < m_Origin.second + (int)m_Grid.ColumnCount();
+		}
+
+		unsigned char& At(int row, int column)
+		{
+			return m_Grid[row - m_Origin.first][column - m_Origin.second];
+		}
+
+		unsigned char At(int row, int column)const
+		{
+			return m_Grid[row - m_Origin.first][column - m_Origin.second];
+		}
+
+		PaletteGrid& GetGrid()
+		{
+			return m_Grid;
+		}
+
+		const PaletteGrid& GetGrid()const
+		{
+			return m_Grid;
+		}
+
+		// Map position of the canvas' first cell
+		std::pair<int, int> GetOrigin()const
+		{
+			return m_Origin;
+		}
+
+		std::pair<int, int> GetMapDimensions()const
+		{
+			return m_MapDimensions;
+		}
+
+	private:
+		void Grow(int rowFirst, int rowLast, int columnFirst, int columnLast)
+		{
+			int rows = (int)m_Grid.RowCount();
+			int columns = (int)m_Grid.ColumnCount();
+			int top = m_Origin.first;
+			int left = m_Origin.second;
+			int bottom = top + rows;
+			int right = left + columns;
+
+			if (rowFirst < top)
+				top = std::max(0, std::min(rowFirst, top - std::max(rows, 1)));
+			if (rowLast >= bottom)
+				bottom = std::min(m_MapDimensions.first, std::max(rowLast + 1, bottom + std::max(rows, 1)));
+			if (columnFirst < left)
+				left = std::max(0, std::min(columnFirst, left - std::max(columns, 1)));
+			if (columnLast >= right)
+				right = std::min(m_MapDimensions.second, std::max(columnLast + 1, right + std::max(columns, 1)));
+
+			// Copy the old window into place inside the larger one
+			m_Spare.SetCellSet(m_Grid.GetCellSet());
+			m_Spare.assign(bottom - top, right - left);
+			for (int x = 0; x < rows; x++)
+			{
+				std::copy_n(m_Grid[x].data(), columns, m_Spare[x + m_Origin.first - top].data() + (m_Origin.second - left));
+			}
+
+			std::swap(m_Grid, m_Spare);
+			m_Origin = std::make_pair(top, left);
+		}
+
+		PaletteGrid m_Grid;
+		PaletteGrid m_Spare;
+		std::pair<int, int> m_Origin;
+		std::pair<int, int> m_MapDimensions;
+	};
+}
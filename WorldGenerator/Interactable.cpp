@@ -4,5 +4,13 @@
 
 namespace WorldGenerator
 {
-
+	Interactable::Interactable()
+	{
+		bCanOverlap = false;
+		NumMaxSpawns = 1;
+		NumRequiredSpawns = 0;
+		RowCount = 1;
+		ColumnCount = 1;
+		Spacing = 0;
+	}
 }
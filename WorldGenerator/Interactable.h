@@ -6,11 +6,16 @@ namespace WorldGenerator
 	class Interactable
 	{
 	public:
+		Interactable();
+
 		bool bCanOverlap;
+		// As many as fit when negative
 		int NumMaxSpawns;
 		int NumRequiredSpawns;
 		int RowCount;
 		int ColumnCount;
+		// Least distance between two spawns of this interactable. 0 keeps them a footprint apart
+		int Spacing;
 	};
 
 }
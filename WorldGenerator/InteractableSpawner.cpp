@@ -0,0 +1,344 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "InteractableSpawner.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace WorldGenerator
+{
+	// Least buckets per tile side
+	static const int TILE_BUCKETS = 8;
+
+	// Smallest bucket side, so tightly spaced interactables do not leave most buckets empty
+	static const int MIN_BUCKET_SIZE = 2;
+
+	// An accepted spawn, listed in the bucket under its top left cell
+	struct SpawnNode
+	{
+		int Row;
+		int Column;
+		unsigned int InteractableIndex;
+		// Next node in the same bucket, or -1
+		int Next;
+	};
+
+	// The buckets inside a tile and the spawns listed in them. Heads are only allocated once
+	// something spawns in the tile, so a few spawns on a large map stay cheap to set up
+	struct SpawnTile
+	{
+		// First node of each bucket, or -1, row by row
+		std::vector<int> Heads;
+		std::vector<SpawnNode> Nodes;
+	};
+
+	static unsigned int GreatestCommonDivisor(unsigned int a, unsigned int b)
+	{
+		while (b)
+		{
+			unsigned int remainder = a % b;
+			a = b;
+			b = remainder;
+		}
+
+		return a;
+	}
+
+	InteractableSpawner::InteractableSpawner()
+	{
+		m_Density = 4;
+		m_RandomEngine = RandomEngineType::Xoshiro256;
+	}
+
+	void InteractableSpawner::AddInteractable(const Interactable& object)
+	{
+		m_Interactables.push_back(object);
+	}
+
+	void InteractableSpawner::AddInteractables(const LandmarkTemplate& landmark)
+	{
+		for (const Interactable* object : landmark.GetInteractables())
+		{
+			if (object)
+				AddInteractable(*object);
+		}
+	}
+
+	void InteractableSpawner::ClearInteractables()
+	{
+		m_Interactables.clear();
+	}
+
+	void InteractableSpawner::SetDensity(unsigned int density)
+	{
+		m_Density = std::max(density, 1u);
+	}
+
+	void InteractableSpawner::SetRandomEngine(RandomEngineType engine)
+	{
+		m_RandomEngine = engine;
+	}
+
+	bool InteractableSpawner::Spawn(const WorldGrid& grid, unsigned int seed, std::vector<InteractableSpawn>& spawns, ThreadPool* pool) const
+	{
+		return Spawn(grid, std::make_pair(0, (int)grid.RowCount()), std::make_pair(0, (int)grid.ColumnCount()), seed, spawns, pool);
+	}
+
+	bool InteractableSpawner::Spawn(const WorldGrid& grid, std::pair<int, int> rowRange, std::pair<int, int> columnRange, unsigned int seed, std::vector<InteractableSpawn>& spawns, ThreadPool* pool) const
+	{
+		bool bSpawnedRequired = false;
+		WithRandomEngine(m_RandomEngine, seed, 0, [&](auto& rng)
+		{
+			typedef typename std::decay<decltype(rng)>::type Engine;
+			bSpawnedRequired = this->SpawnWith<Engine>(grid, rowRange, columnRange, seed, spawns, pool);
+		});
+
+		return bSpawnedRequired;
+	}
+
+	template<typename Engine>
+	bool InteractableSpawner::SpawnWith(const WorldGrid& grid, std::pair<int, int> rowRange, std::pair<int, int> columnRange, unsigned int seed, std::vector<InteractableSpawn>& spawns, ThreadPool* pool) const
+	{
+		spawns.clear();
+		rowRange = std::make_pair(std::max(rowRange.first, 0), std::min(rowRange.second, (int)grid.RowCount()));
+		columnRange = std::make_pair(std::max(columnRange.first, 0), std::min(columnRange.second, (int)grid.ColumnCount()));
+		const int rows = std::max(rowRange.second - rowRange.first, 0);
+		const int columns = std::max(columnRange.second - columnRange.first, 0);
+		const unsigned int objectCount = (unsigned int)m_Interactables.size();
+
+		// Buckets are as wide as the tightest spacing, so a dense interactable finds few spawns
+		// per bucket. Checks reaching further read more buckets, but interactables spaced wider
+		// also throw fewer darts, so the buckets read per area stay about the same
+		int bucketSize = 0;
+		int maxRowCount = 1;
+		int maxColumnCount = 1;
+		int maxReach = 1;
+		for (const Interactable& object : m_Interactables)
+		{
+			const int spacing = GetSpacing(object);
+			bucketSize = bucketSize ? std::min(bucketSize, spacing) : spacing;
+			maxRowCount = std::max(maxRowCount, object.RowCount);
+			maxColumnCount = std::max(maxColumnCount, object.ColumnCount);
+			maxReach = std::max(maxReach, std::max(spacing, std::max(object.RowCount, object.ColumnCount)));
+		}
+
+		bucketSize = std::max(bucketSize, MIN_BUCKET_SIZE);
+
+		// Tiles are wider than any check reaches, so a tile only reads the tiles next to it
+		const int tileBuckets = std::max(TILE_BUCKETS, maxReach / bucketSize + 1);
+		const int bucketRows = (rows + bucketSize - 1) / bucketSize;
+		const int bucketColumns = (columns + bucketSize - 1) / bucketSize;
+		const int tileRows = (bucketRows + tileBuckets - 1) / tileBuckets;
+		const int tileColumns = (bucketColumns + tileBuckets - 1) / tileBuckets;
+		const unsigned int tileCount = (unsigned int)(tileRows * tileColumns);
+
+		// Each tile owns the buckets inside it and the nodes listed in them
+		std::vector<SpawnTile> tiles(tileCount);
+		std::vector<unsigned int> firstNodes(tileCount);
+
+		// Tiles are split in four by the parity of their row and column. Tiles sharing a parity
+		// are never next to each other, so they can spawn at once without reading each other
+		std::vector<unsigned int> phaseTiles[4];
+		for (unsigned int tile = 0; tile < tileCount; tile++)
+		{
+			const int tileRow = tile / tileColumns;
+			const int tileColumn = tile % tileColumns;
+			phaseTiles[(tileRow & 1) * 2 + (tileColumn & 1)].push_back(tile);
+		}
+
+		bool bSpawnedRequired = true;
+		for (unsigned int objectIndex = 0; objectIndex < objectCount; objectIndex++)
+		{
+			const Interactable& object = m_Interactables[objectIndex];
+			const int spacing = GetSpacing(object);
+			const long long spacingSquared = (long long)spacing * spacing;
+
+			// Top left cells that keep the footprint inside the region
+			const int lastRow = rowRange.second - object.RowCount;
+			const int lastColumn = columnRange.second - object.ColumnCount;
+			if (object.NumMaxSpawns == 0 || object.RowCount <= 0 || object.ColumnCount <= 0 || lastRow < rowRange.first || lastColumn < columnRange.first)
+			{
+				bSpawnedRequired &= object.NumRequiredSpawns <= 0;
+				continue;
+			}
+
+			for (unsigned int tile = 0; tile < tileCount; tile++)
+			{
+				firstNodes[tile] = (unsigned int)tiles[tile].Nodes.size();
+			}
+
+			// Whether a spawn at the cell would come too close to or overlap one already made
+			auto isBlocked = [&](int row, int column)
+			{
+				// Spawns are listed under their top left cell, so look back far enough to find the
+				// largest footprint that could cover this one
+				const int firstBucketRow = std::max(row - std::max(spacing, maxRowCount) + 1 - rowRange.first, 0) / bucketSize;
+				const int lastBucketRow = std::min((row + std::max(spacing, object.RowCount) - 1 - rowRange.first) / bucketSize, bucketRows - 1);
+				const int firstBucketColumn = std::max(column - std::max(spacing, maxColumnCount) + 1 - columnRange.first, 0) / bucketSize;
+				const int lastBucketColumn = std::min((column + std::max(spacing, object.ColumnCount) - 1 - columnRange.first) / bucketSize, bucketColumns - 1);
+				for (int nearRow = firstBucketRow; nearRow <= lastBucketRow; nearRow++)
+				{
+					for (int nearColumn = firstBucketColumn; nearColumn <= lastBucketColumn; nearColumn++)
+					{
+						const SpawnTile& nearTile = tiles[(nearRow / tileBuckets) * tileColumns + nearColumn / tileBuckets];
+						if (nearTile.Heads.empty())
+							continue;
+
+						for (int node = nearTile.Heads[(nearRow % tileBuckets) * tileBuckets + nearColumn % tileBuckets]; node >= 0; node = nearTile.Nodes[node].Next)
+						{
+							const SpawnNode& spawned = nearTile.Nodes[node];
+							const long long rowDistance = spawned.Row - row;
+							const long long columnDistance = spawned.Column - column;
+							if (spawned.InteractableIndex == objectIndex && rowDistance * rowDistance + columnDistance * columnDistance < spacingSquared)
+								return true;
+
+							const Interactable& other = m_Interactables[spawned.InteractableIndex];
+							if (object.bCanOverlap && other.bCanOverlap)
+								continue;
+
+							if (spawned.Row < row + object.RowCount && row < spawned.Row + other.RowCount && spawned.Column < column + object.ColumnCount && column < spawned.Column + other.ColumnCount)
+								return true;
+						}
+					}
+				}
+
+				return false;
+			};
+
+			// Cells of the tile a spawn's top left cell may land on. False when there are none
+			auto getTileCells = [&](unsigned int tile, int& firstTileRow, int& lastTileRow, int& firstTileColumn, int& lastTileColumn)
+			{
+				firstTileRow = rowRange.first + (tile / tileColumns) * tileBuckets * bucketSize;
+				firstTileColumn = columnRange.first + (tile % tileColumns) * tileBuckets * bucketSize;
+				lastTileRow = std::min(firstTileRow + tileBuckets * bucketSize - 1, lastRow);
+				lastTileColumn = std::min(firstTileColumn + tileBuckets * bucketSize - 1, lastColumn);
+				return lastTileRow >= firstTileRow && lastTileColumn >= firstTileColumn;
+			};
+
+			// Darts the tile gets, a fixed number per spacing squared of area
+			auto getDartCount = [&](int firstTileRow, int lastTileRow, int firstTileColumn, int lastTileColumn)
+			{
+				const double area = (double)(lastTileRow - firstTileRow + 1) * (lastTileColumn - firstTileColumn + 1);
+				return (unsigned long long)std::ceil(m_Density * area / std::max(spacingSquared, 1LL));
+			};
+
+			// Spawns at the cell, which lies in the tile, unless something is in the way
+			const size_t footprint = (size_t)object.RowCount * object.ColumnCount;
+			auto trySpawn = [&](unsigned int tile, int row, int column)
+			{
+				if (grid.CountPassable(std::make_pair(row, row + object.RowCount), std::make_pair(column, column + object.ColumnCount)) != footprint)
+					return false;
+
+				if (isBlocked(row, column))
+					return false;
+
+				SpawnTile& spawnTile = tiles[tile];
+				if (spawnTile.Heads.empty())
+					spawnTile.Heads.assign((size_t)tileBuckets * tileBuckets, -1);
+
+				const int bucketRow = (row - rowRange.first) / bucketSize;
+				const int bucketColumn = (column - columnRange.first) / bucketSize;
+				int& head = spawnTile.Heads[(bucketRow % tileBuckets) * tileBuckets + bucketColumn % tileBuckets];
+				spawnTile.Nodes.push_back({ row, column, objectIndex, head });
+				head = (int)spawnTile.Nodes.size() - 1;
+				return true;
+			};
+
+			unsigned int spawnCount = 0;
+			if (object.NumMaxSpawns < 0)
+			{
+				// As many as fit, so throw every tile's darts, tiles sharing a parity at once
+				for (const std::vector<unsigned int>& phase : phaseTiles)
+				{
+					ThreadPool::ParallelFor(pool, (unsigned int)phase.size(), [&](unsigned int entry, unsigned int)
+					{
+						const unsigned int tile = phase[entry];
+						int firstTileRow, lastTileRow, firstTileColumn, lastTileColumn;
+						if (!getTileCells(tile, firstTileRow, lastTileRow, firstTileColumn, lastTileColumn))
+							return;
+
+						const unsigned long long dartCount = getDartCount(firstTileRow, lastTileRow, firstTileColumn, lastTileColumn);
+						Engine rng = MakeEngine<Engine>(seed, ((unsigned long long)objectIndex << 32) | tile);
+						for (unsigned long long dart = 0; dart < dartCount; dart++)
+						{
+							trySpawn(tile, UniformRange(rng, firstTileRow, lastTileRow), UniformRange(rng, firstTileColumn, lastTileColumn));
+						}
+					});
+				}
+
+				for (unsigned int tile = 0; tile < tileCount; tile++)
+				{
+					const std::vector<SpawnNode>& nodes = tiles[tile].Nodes;
+					for (unsigned int node = firstNodes[tile]; node < (unsigned int)nodes.size(); node++)
+					{
+						spawns.push_back({ objectIndex, nodes[node].Row, nodes[node].Column });
+						spawnCount++;
+					}
+				}
+			}
+			else
+			{
+				// A capped count stops as soon as it is reached, so the work follows the spawns asked
+				// for rather than the area. Rounds throw one dart at every tile, visiting the tiles in
+				// a seeded stride order, so the spawns spread over the whole region. A tile drops out
+				// once it has thrown the darts the uncapped pass would give it. This runs on one
+				// thread, which keeps it independent of the pool
+				Engine rng = MakeEngine<Engine>(seed, ((unsigned long long)objectIndex << 32) | 0xffffffffull);
+				const unsigned int firstTile = (unsigned int)UniformRange(rng, 0, (int)tileCount - 1);
+				unsigned int stride = (unsigned int)UniformRange(rng, 1, std::max((int)tileCount - 1, 1));
+				while (GreatestCommonDivisor(stride, tileCount) != 1)
+				{
+					stride++;
+				}
+
+				bool bThrewDart = true;
+				for (unsigned long long round = 0; bThrewDart && spawnCount < (unsigned int)object.NumMaxSpawns; round++)
+				{
+					bThrewDart = false;
+					unsigned int tile = firstTile;
+					for (unsigned int visit = 0; visit < tileCount && spawnCount < (unsigned int)object.NumMaxSpawns; visit++)
+					{
+						int firstTileRow, lastTileRow, firstTileColumn, lastTileColumn;
+						if (getTileCells(tile, firstTileRow, lastTileRow, firstTileColumn, lastTileColumn) && round < getDartCount(firstTileRow, lastTileRow, firstTileColumn, lastTileColumn))
+						{
+							bThrewDart = true;
+							const int row = UniformRange(rng, firstTileRow, lastTileRow);
+							const int column = UniformRange(rng, firstTileColumn, lastTileColumn);
+							if (trySpawn(tile, row, column))
+							{
+								spawns.push_back({ objectIndex, row, column });
+								spawnCount++;
+							}
+						}
+
+						tile = (unsigned int)(((unsigned long long)tile + stride) % tileCount);
+					}
+				}
+			}
+
+			bSpawnedRequired &= spawnCount >= (unsigned int)std::max(object.NumRequiredSpawns, 0);
+		}
+
+		return bSpawnedRequired;
+	}
+
+	int InteractableSpawner::GetSpacing(const Interactable& object) const
+	{
+		return (object.Spacing > 0) ? object.Spacing : std::max(object.RowCount, object.ColumnCount);
+	}
+
+	const std::vector<Interactable>& InteractableSpawner::GetInteractables() const
+	{
+		return m_Interactables;
+	}
+
+	unsigned int InteractableSpawner::GetDensity() const
+	{
+		return m_Density;
+	}
+
+	RandomEngineType InteractableSpawner::GetRandomEngine() const
+	{
+		return m_RandomEngine;
+	}
+}
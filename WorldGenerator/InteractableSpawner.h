@@ -0,0 +1,71 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "LandmarkTemplate.h"
+#include "ThreadPool.h"
+#include <vector>
+
+namespace WorldGenerator
+{
+	// An interactable spawned by InteractableSpawner
+	struct InteractableSpawn
+	{
+		// Which of the spawner's interactables this is, in the order they were added
+		unsigned int InteractableIndex;
+		// Top left cell of the footprint
+		int Row;
+		int Column;
+	};
+
+	// Spawns interactables on passable cells. Each interactable is spread by Poisson-disk
+	// sampling, so no two of its spawns are closer than its spacing, and footprints only
+	// overlap when both interactables allow it. The area is split into tiles handled in
+	// parallel, in four passes so tiles running at once are never next to each other.
+	// Spawns are hashed into buckets as wide as the furthest check reaches, so checking a
+	// candidate only reads the spawns around it, not every spawn already made. Interactables
+	// with a NumMaxSpawns stop once they have that many, so they cost about as much as the
+	// spawns asked for. Only uncapped ones cover the whole area
+	class InteractableSpawner
+	{
+	public:
+		InteractableSpawner();
+
+		void AddInteractable(const Interactable& object);
+
+		// Adds every interactable a landmark can hold
+		void AddInteractables(const LandmarkTemplate& landmark);
+
+		void ClearInteractables();
+
+		// Candidates tried per spacing squared of area. Higher fills the area more tightly
+		void SetDensity(unsigned int density);
+
+		// Selects the engine candidates are rolled with
+		void SetRandomEngine(RandomEngineType engine);
+
+		// Spawns into the whole grid, listed by interactable. Earlier interactables get first pick where they compete
+		// for room. Reads the grid's passable layer, so the layers have to be up to date.
+		// The same seed gives the same spawns with any pool, and runs on the calling thread when
+		// none is given. Returns false when an interactable fell short of its required spawns
+		bool Spawn(const WorldGrid& grid, unsigned int seed, std::vector<InteractableSpawn>& spawns, ThreadPool* pool = nullptr)const;
+
+		// Spawns with every footprint inside [rowRange.first, rowRange.second) x [columnRange.first, columnRange.second),
+		// e.g. the area of a placed landmark
+		bool Spawn(const WorldGrid& grid, std::pair<int, int> rowRange, std::pair<int, int> columnRange, unsigned int seed, std::vector<InteractableSpawn>& spawns, ThreadPool* pool = nullptr)const;
+
+		const std::vector<Interactable>& GetInteractables()const;
+		unsigned int GetDensity()const;
+		RandomEngineType GetRandomEngine()const;
+
+	private:
+		template<typename Engine>
+		bool SpawnWith(const WorldGrid& grid, std::pair<int, int> rowRange, std::pair<int, int> columnRange, unsigned int seed, std::vector<InteractableSpawn>& spawns, ThreadPool* pool)const;
+
+		// Spacing with 0 resolved to the footprint's larger side
+		int GetSpacing(const Interactable& object)const;
+
+		std::vector<Interactable> m_Interactables;
+		unsigned int m_Density;
+		RandomEngineType m_RandomEngine;
+	};
+}
@@ -0,0 +1,338 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "LandmarkPlacer.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace WorldGenerator
+{
+	// Copies rolled or stamped per pool task
+	static const unsigned int PLACEMENT_BLOCK = 1024;
+
+	// Rows of layers rebuilt per pool task
+	static const int LAYER_BAND = 64;
+
+	// Uniform grid of buckets over the map. A rectangle is listed in every bucket it covers,
+	// so a query only reads the buckets under it. Buckets are linked lists threaded through
+	// one node array, with each node holding its rectangle so a query follows no other pointers
+	class RectIndex
+	{
+	public:
+		RectIndex(std::pair<int, int> dimensions, int bucketSize, size_t expectedCount) :
+			m_BucketSize(std::max(bucketSize, 1)),
+			m_BucketRows((dimensions.first + m_BucketSize - 1) / m_BucketSize),
+			m_BucketColumns((dimensions.second + m_BucketSize - 1) / m_BucketSize),
+			m_Heads((size_t)m_BucketRows * m_BucketColumns, -1)
+		{
+			m_Nodes.reserve(expectedCount * 4);
+		}
+
+		// Whether any rectangle shares a cell with [rows.first, rows.second) x [columns.first, columns.second)
+		bool Overlaps(std::pair<int, int> rows, std::pair<int, int> columns)const
+		{
+			const int firstRow = std::max(rows.first / m_BucketSize, 0);
+			const int lastRow = std::min((rows.second - 1) / m_BucketSize, m_BucketRows - 1);
+			const int firstColumn = std::max(columns.first / m_BucketSize, 0);
+			const int lastColumn = std::min((columns.second - 1) / m_BucketSize, m_BucketColumns - 1);
+			for (int bucketRow = firstRow; bucketRow <= lastRow; bucketRow++)
+			{
+				for (int bucketColumn = firstColumn; bucketColumn <= lastColumn; bucketColumn++)
+				{
+					for (int node = m_Heads[(size_t)bucketRow * m_BucketColumns + bucketColumn]; node >= 0; node = m_Nodes[node].Next)
+					{
+						const Node& rect = m_Nodes[node];
+						if (rect.Rows.first < rows.second && rows.first < rect.Rows.second && rect.Columns.first < columns.second && columns.first < rect.Columns.second)
+							return true;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		void Insert(std::pair<int, int> rows, std::pair<int, int> columns)
+		{
+			for (int bucketRow = rows.first / m_BucketSize; bucketRow <= (rows.second - 1) / m_BucketSize; bucketRow++)
+			{
+				for (int bucketColumn = columns.first / m_BucketSize; bucketColumn <= (columns.second - 1) / m_BucketSize; bucketColumn++)
+				{
+					int& head = m_Heads[(size_t)bucketRow * m_BucketColumns + bucketColumn];
+					m_Nodes.push_back({ rows, columns, head });
+					head = (int)m_Nodes.size() - 1;
+				}
+			}
+		}
+
+	private:
+		struct Node
+		{
+			std::pair<int, int> Rows;
+			std::pair<int, int> Columns;
+			// Next node in the same bucket, or -1
+			int Next;
+		};
+
+		int m_BucketSize;
+		int m_BucketRows;
+		int m_BucketColumns;
+		// First node of each bucket, or -1
+		std::vector<int> m_Heads;
+		std::vector<Node> m_Nodes;
+	};
+
+	// A rolled copy and the position of its first attempt
+	struct LandmarkCandidate
+	{
+		LandmarkRoll Roll;
+		int Row;
+		int Column;
+		bool bFits;
+	};
+
+	LandmarkPlacer::LandmarkPlacer()
+	{
+		m_FirstCopies.push_back(0);
+		m_Spacing = 0;
+		m_MaxAttempts = 8;
+		m_bPassableOnly = false;
+		m_RandomEngine = RandomEngineType::Xoshiro256;
+	}
+
+	void LandmarkPlacer::AddLandmarks(const LandmarkTemplate& landmark, unsigned int count)
+	{
+		m_Landmarks.push_back(&landmark);
+		m_FirstCopies.push_back(m_FirstCopies.back() + count);
+	}
+
+	void LandmarkPlacer::ClearLandmarks()
+	{
+		m_Landmarks.clear();
+		m_FirstCopies.assign(1, 0);
+	}
+
+	void LandmarkPlacer::SetSpacing(int cells)
+	{
+		m_Spacing = std::max(cells, 0);
+	}
+
+	void LandmarkPlacer::SetMaxAttempts(unsigned int attempts)
+	{
+		m_MaxAttempts = std::max(attempts, 1u);
+	}
+
+	void LandmarkPlacer::SetPassableOnly(bool bEnabled)
+	{
+		m_bPassableOnly = bEnabled;
+	}
+
+	void LandmarkPlacer::SetRandomEngine(RandomEngineType engine)
+	{
+		m_RandomEngine = engine;
+	}
+
+	bool LandmarkPlacer::Place(WorldGrid& grid, unsigned int seed, std::vector<LandmarkPlacement>& placements, ThreadPool* pool) const
+	{
+		bool bPlacedAll = false;
+		WithRandomEngine(m_RandomEngine, seed, 0, [&](auto& rng)
+		{
+			typedef typename std::decay<decltype(rng)>::type Engine;
+			bPlacedAll = this->PlaceWith<Engine>(grid, seed, placements, pool);
+		});
+
+		return bPlacedAll;
+	}
+
+	template<typename Engine>
+	bool LandmarkPlacer::PlaceWith(WorldGrid& grid, unsigned int seed, std::vector<LandmarkPlacement>& placements, ThreadPool* pool) const
+	{
+		placements.clear();
+		const unsigned int copyCount = m_FirstCopies.back();
+		const int rows = (int)grid.RowCount();
+		const int columns = (int)grid.ColumnCount();
+
+		// Each attempt of each copy has its own stream, so any attempt can be rolled on its own
+		auto rollPosition = [&](const LandmarkRoll& roll, unsigned int copy, unsigned int attempt, LandmarkCandidate& candidate)
+		{
+			Engine rng = MakeEngine<Engine>(seed, ((unsigned long long)copy << 32) | attempt);
+			candidate.Row = UniformRange(rng, 0, rows - roll.RowCount);
+			candidate.Column = UniformRange(rng, 0, columns - roll.ColumnCount);
+			candidate.bFits = roll.RowCount > 0 && roll.ColumnCount > 0 && roll.RowCount <= rows && roll.ColumnCount <= columns;
+			if (candidate.bFits && m_bPassableOnly)
+			{
+				size_t passable = grid.CountPassable(std::make_pair(candidate.Row, candidate.Row + roll.RowCount), std::make_pair(candidate.Column, candidate.Column + roll.ColumnCount));
+				candidate.bFits = passable == (size_t)roll.RowCount * roll.ColumnCount;
+			}
+		};
+
+		// Roll every copy and its first position in parallel
+		std::vector<LandmarkCandidate> candidates(copyCount);
+		std::vector<unsigned int> copyLandmarks(copyCount);
+		ThreadPool::ParallelFor(pool, (copyCount + PLACEMENT_BLOCK - 1) / PLACEMENT_BLOCK, [&](unsigned int block, unsigned int)
+		{
+			const unsigned int last = std::min(copyCount, (block + 1) * PLACEMENT_BLOCK);
+			for (unsigned int copy = block * PLACEMENT_BLOCK; copy < last; copy++)
+			{
+				const unsigned int landmark = (unsigned int)(std::upper_bound(m_FirstCopies.begin(), m_FirstCopies.end(), copy) - m_FirstCopies.begin()) - 1;
+				copyLandmarks[copy] = landmark;
+
+				LandmarkCandidate& candidate = candidates[copy];
+				if (!m_Landmarks[landmark]->IsValid())
+				{
+					candidate.Roll = LandmarkRoll();
+					candidate.Row = 0;
+					candidate.Column = 0;
+					candidate.bFits = false;
+					continue;
+				}
+
+				candidate.Roll = m_Landmarks[landmark]->RollLandmark((unsigned int)DeriveSeed(seed, copy));
+				rollPosition(candidate.Roll, copy, 0, candidate);
+			}
+		});
+
+		// Size buckets to an average landmark, so most are listed in a few buckets and each bucket
+		// holds a few landmarks. On sparse maps, keep the bucket count near the landmark count
+		double extentTotal = 0;
+		for (const LandmarkCandidate& candidate : candidates)
+		{
+			extentTotal += std::max(candidate.Roll.RowCount, candidate.Roll.ColumnCount);
+		}
+
+		double area = (double)std::max(rows, 1) * std::max(columns, 1);
+		int bucketSize = std::max((int)(extentTotal / std::max(copyCount, 1u)) + m_Spacing, (int)std::ceil(std::sqrt(area / (4.0 * std::max(copyCount, 1u)))));
+		RectIndex index(std::make_pair(rows, columns), bucketSize, copyCount);
+
+		// Every landmark still waiting tries one position per round. Positions are rolled in
+		// parallel, then accepted in copy order so the result does not depend on the pool
+		std::vector<unsigned int> waiting;
+		waiting.reserve(copyCount);
+		for (unsigned int copy = 0; copy < copyCount; copy++)
+		{
+			if (candidates[copy].Roll.RowCount > 0)
+				waiting.push_back(copy);
+		}
+
+		for (unsigned int attempt = 0; attempt < m_MaxAttempts && !waiting.empty(); attempt++)
+		{
+			if (attempt > 0)
+			{
+				const unsigned int waitingCount = (unsigned int)waiting.size();
+				ThreadPool::ParallelFor(pool, (waitingCount + PLACEMENT_BLOCK - 1) / PLACEMENT_BLOCK, [&](unsigned int block, unsigned int)
+				{
+					const unsigned int last = std::min(waitingCount, (block + 1) * PLACEMENT_BLOCK);
+					for (unsigned int entry = block * PLACEMENT_BLOCK; entry < last; entry++)
+					{
+						LandmarkCandidate& candidate = candidates[waiting[entry]];
+						rollPosition(candidate.Roll, waiting[entry], attempt, candidate);
+					}
+				});
+			}
+
+			unsigned int kept = 0;
+			for (unsigned int copy : waiting)
+			{
+				const LandmarkCandidate& candidate = candidates[copy];
+				std::pair<int, int> landmarkRows(candidate.Row, candidate.Row + candidate.Roll.RowCount);
+				std::pair<int, int> landmarkColumns(candidate.Column, candidate.Column + candidate.Roll.ColumnCount);
+				if (!candidate.bFits || index.Overlaps(std::make_pair(landmarkRows.first - m_Spacing, landmarkRows.second + m_Spacing), std::make_pair(landmarkColumns.first - m_Spacing, landmarkColumns.second + m_Spacing)))
+				{
+					waiting[kept++] = copy;
+					continue;
+				}
+
+				index.Insert(landmarkRows, landmarkColumns);
+				placements.push_back({ copyLandmarks[copy], candidate.Row, candidate.Column, candidate.Roll });
+			}
+
+			waiting.resize(kept);
+		}
+
+		// Placed landmarks never share a cell, so they can be stamped side by side
+		const unsigned int placementCount = (unsigned int)placements.size();
+		ThreadPool::ParallelFor(pool, (placementCount + PLACEMENT_BLOCK - 1) / PLACEMENT_BLOCK, [&](unsigned int block, unsigned int)
+		{
+			const unsigned int last = std::min(placementCount, (block + 1) * PLACEMENT_BLOCK);
+			for (unsigned int placement = block * PLACEMENT_BLOCK; placement < last; placement++)
+			{
+				const LandmarkPlacement& placed = placements[placement];
+				m_Landmarks[placed.LandmarkIndex]->StampLandmark(placed.Roll, grid, placed.Row, placed.Column);
+			}
+		});
+
+		// Rebuild only the layer words under each landmark. Landmarks side by side can share a
+		// word, so work is split by bands of rows: each band rebuilds its rows of every landmark
+		// crossing it. Sizing the layers first keeps the bands from racing to do it
+		const BitGrid& layer = grid.GetPassableLayer();
+		if (layer.RowCount() != (unsigned int)rows || layer.ColumnCount() != (unsigned int)columns)
+		{
+			grid.RebuildLayers();
+			return placements.size() == copyCount;
+		}
+
+		// Bucket the placements by band, counting first so the lists share one array
+		const unsigned int bandCount = (rows + LAYER_BAND - 1) / LAYER_BAND;
+		std::vector<unsigned int> bandStarts(bandCount + 1, 0);
+		for (const LandmarkPlacement& placed : placements)
+		{
+			for (int band = placed.Row / LAYER_BAND; band <= (placed.Row + placed.Roll.RowCount - 1) / LAYER_BAND; band++)
+			{
+				bandStarts[band + 1]++;
+			}
+		}
+
+		for (unsigned int band = 0; band < bandCount; band++)
+		{
+			bandStarts[band + 1] += bandStarts[band];
+		}
+
+		std::vector<unsigned int> bandPlacements(bandStarts[bandCount]);
+		std::vector<unsigned int> bandFill(bandStarts.begin(), bandStarts.end() - 1);
+		for (unsigned int placement = 0; placement < placementCount; placement++)
+		{
+			const LandmarkPlacement& placed = placements[placement];
+			for (int band = placed.Row / LAYER_BAND; band <= (placed.Row + placed.Roll.RowCount - 1) / LAYER_BAND; band++)
+			{
+				bandPlacements[bandFill[band]++] = placement;
+			}
+		}
+
+		ThreadPool::ParallelFor(pool, bandCount, [&](unsigned int band, unsigned int)
+		{
+			const int firstRow = band * LAYER_BAND;
+			for (unsigned int entry = bandStarts[band]; entry < bandStarts[band + 1]; entry++)
+			{
+				const LandmarkPlacement& placed = placements[bandPlacements[entry]];
+				std::pair<int, int> landmarkRows(std::max(placed.Row, firstRow), std::min(placed.Row + placed.Roll.RowCount, firstRow + LAYER_BAND));
+				grid.RebuildLayers(landmarkRows, std::make_pair(placed.Column, placed.Column + placed.Roll.ColumnCount));
+			}
+		});
+
+		return placements.size() == copyCount;
+	}
+
+	int LandmarkPlacer::GetSpacing() const
+	{
+		return m_Spacing;
+	}
+
+	unsigned int LandmarkPlacer::GetMaxAttempts() const
+	{
+		return m_MaxAttempts;
+	}
+
+	bool LandmarkPlacer::IsPassableOnly() const
+	{
+		return m_bPassableOnly;
+	}
+
+	RandomEngineType LandmarkPlacer::GetRandomEngine() const
+	{
+		return m_RandomEngine;
+	}
+
+	unsigned int LandmarkPlacer::GetLandmarkCount() const
+	{
+		return m_FirstCopies.back();
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "LandmarkTemplate.h"
+#include "ThreadPool.h"
+#include <vector>
+
+namespace WorldGenerator
+{
+	// A landmark stamped into a grid by LandmarkPlacer
+	struct LandmarkPlacement
+	{
+		// Which of the placer's landmarks this is, in the order they were added
+		unsigned int LandmarkIndex;
+		// Top left cell on the grid
+		int Row;
+		int Column;
+		LandmarkRoll Roll;
+	};
+
+	// Stamps many landmarks into a generated grid without letting them overlap. Landmarks are
+	// rolled and given candidate positions in parallel, then accepted in order against a
+	// uniform grid of buckets holding the landmarks already placed. Checking a candidate
+	// only looks at the buckets it covers, so the cost grows with the number of landmarks
+	// rather than with the map's area
+	class LandmarkPlacer
+	{
+	public:
+		LandmarkPlacer();
+
+		// Places count copies of landmark, each rolled separately. The landmark must outlive the placer
+		void AddLandmarks(const LandmarkTemplate& landmark, unsigned int count);
+		void ClearLandmarks();
+
+		// Cells kept clear between any two landmarks
+		void SetSpacing(int cells);
+
+		// Positions tried for a landmark before it is dropped, which is also the number of rounds
+		void SetMaxAttempts(unsigned int attempts);
+
+		// Only places landmarks over cells that are all passable, e.g. the carved part of a map.
+		// Reads the grid's passable layer, so the layers have to be up to date
+		void SetPassableOnly(bool bEnabled);
+
+		// Selects the engine positions are rolled with. Landmarks roll themselves with their own engine
+		void SetRandomEngine(RandomEngineType engine);
+
+		// Rolls and places every landmark into grid and rebuilds the layers under them. Placing
+		// goes in rounds: each landmark not yet placed tries one new position, in the order the
+		// landmarks were added, and takes it when it is clear. Placements receives the ones that were placed. The same seed gives the
+		// same placements with any pool, and runs on the calling thread when none is given.
+		// Returns false when some landmark could not be placed
+		bool Place(WorldGrid& grid, unsigned int seed, std::vector<LandmarkPlacement>& placements, ThreadPool* pool = nullptr)const;
+
+		int GetSpacing()const;
+		unsigned int GetMaxAttempts()const;
+		bool IsPassableOnly()const;
+		RandomEngineType GetRandomEngine()const;
+		unsigned int GetLandmarkCount()const;
+
+	private:
+		template<typename Engine>
+		bool PlaceWith(WorldGrid& grid, unsigned int seed, std::vector<LandmarkPlacement>& placements, ThreadPool* pool)const;
+
+		std::vector<const LandmarkTemplate*> m_Landmarks;
+		// Running total of copies, so landmark i covers [m_FirstCopies[i], m_FirstCopies[i + 1])
+		std::vector<unsigned int> m_FirstCopies;
+		int m_Spacing;
+		unsigned int m_MaxAttempts;
+		bool m_bPassableOnly;
+		RandomEngineType m_RandomEngine;
+	};
+}
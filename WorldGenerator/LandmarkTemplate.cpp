@@ -1,7 +1,6 @@
 // Created by Eric Marquez. All rights reserved
 
 #include "LandmarkTemplate.h"
-#include <random>
 #include <ctime>
 
 namespace WorldGenerator
@@ -26,6 +25,7 @@ namespace WorldGenerator
 		m_HeightRange = std::make_pair(0, 0);
 		m_CellSet = nullptr;
 		m_PassageWayCount = 1;
+		m_RandomEngine = RandomEngineType::Xoshiro256;
 	}
 
 	// Extra for ease of acess
@@ -36,6 +36,7 @@ namespace WorldGenerator
 		m_HeightRange = std::make_pair(0, 0);
 		m_CellSet = nullptr;
 		m_PassageWayCount = 1;
+		m_RandomEngine = RandomEngineType::Xoshiro256;
 
 		SetDefaults(minRowSize, maxRowSize, minColumnSize, maxColumnSize, cellSetName);
 	}
@@ -49,51 +50,67 @@ namespace WorldGenerator
 	// Generates an array for the current alloted space using a non-zero seed
 	bool LandmarkTemplate::GenerateLandmark(WorldGrid& grid, unsigned int seed)
 	{
-		// Make sure the cell set is valid
-		if (!m_CellSet)
-			return false;
-
-		// Make sure the size range is valid
-		if(!m_RowRange.first || !m_RowRange.second || ! m_ColumnRange.first || !m_ColumnRange.second)
+		if (!IsValid())
 			return false;
 
 		// Set seed if not set
 		seed = (seed) ? seed : (unsigned)time(0);
 
-		// Roll row and column values
-		std::mt19937 rng(seed);
+		LandmarkRoll roll = RollLandmark(seed);
+		grid.reshape(roll.RowCount, roll.ColumnCount);
+		StampLandmark(roll, grid, 0, 0);
+		grid.RebuildLayers();
 
-		// distribution in range [rowMin, rowMax]
-		std::uniform_int_distribution<std::mt19937::result_type> rowDistribution(m_RowRange.first, m_RowRange.second);
+		m_ExitPositions.clear();
+		GetExitPositions(roll, 0, 0, m_ExitPositions);
+		return true;
+	}
+
+	bool LandmarkTemplate::IsValid() const
+	{
+		// Make sure the cell set is valid
+		if (!m_CellSet)
+			return false;
 
-		// distribution in range [columnMin, columnMax]
-		std::uniform_int_distribution<std::mt19937::result_type> columnDistribution(m_ColumnRange.first, m_ColumnRange.second);
+		// Make sure the size range is valid
+		return m_RowRange.first && m_RowRange.second && m_ColumnRange.first && m_ColumnRange.second;
+	}
 
-		// distribution in range [elevationMin, elevationMax]
-		std::uniform_int_distribution<std::mt19937::result_type> heightDistribution(m_HeightRange.first, m_HeightRange.second);
+	// Roll row and column values
+	LandmarkRoll LandmarkTemplate::RollLandmark(unsigned int seed) const
+	{
+		LandmarkRoll roll;
+		WithRandomEngine(m_RandomEngine, seed, 0, [&](auto& rng)
+		{
+			roll.RowCount = UniformRange(rng, m_RowRange.first, m_RowRange.second);
+			roll.ColumnCount = UniformRange(rng, m_RowRange.first, m_RowRange.second);
+			roll.Depth = UniformRange(rng, m_HeightRange.first, m_HeightRange.second);
+			for (bool& bExit : roll.bExits)
+			{
+				bExit = UniformBool(rng);
+			}
+		});
 
-		// distribution in range [exit1, exit4]
-		std::uniform_int_distribution<std::mt19937::result_type> exit1CountDistribution(0, 1);
-		std::uniform_int_distribution<std::mt19937::result_type> exit2CountDistribution(0, 1);
-		std::uniform_int_distribution<std::mt19937::result_type> exit3CountDistribution(0, 1);
-		std::uniform_int_distribution<std::mt19937::result_type> exit4CountDistribution(0, 1);
+		return roll;
+	}
 
-		int rowCount = rowDistribution(rng);
-		int columnCount = rowDistribution(rng);
-		int startDepth = heightDistribution(rng);
-		int exit1 = exit1CountDistribution(rng);
-		int exit2 = exit2CountDistribution(rng);
-		int exit3 = exit3CountDistribution(rng);
-		int exit4 = exit4CountDistribution(rng);
+	void LandmarkTemplate::StampLandmark(const LandmarkRoll& roll, WorldGrid& grid, int row, int column) const
+	{
+		const int rowCount = roll.RowCount;
+		const int columnCount = roll.ColumnCount;
+		const bool exit1 = roll.bExits[0];
+		const bool exit2 = roll.bExits[1];
+		const bool exit3 = roll.bExits[2];
+		const bool exit4 = roll.bExits[3];
 
 		// Get the correct cell type for the current settings
-		std::vector<CellType> cellTypes = GetBorderTypes(startDepth);
+		CellType cellTypes[8];
+		GetBorderTypes(roll.Depth, cellTypes);
 
 		// Start generation process
-		grid.resize(rowCount);
 		for (int x = 0; x < rowCount; x++)
 		{
-			grid[x].resize(columnCount);
+			Cell* cells = grid[row + x].data() + column;
 			for (int y = 0; y < columnCount; y++)
 			{
 				Cell current = m_CellSet->GetCell(CellType::Default);
@@ -157,11 +174,9 @@ namespace WorldGenerator
 					}
 				}
 
-				grid[x][y] = current;
+				cells[y] = current;
 			}
 		}
-
-		return true;
 	}
 
 	// Sets the default settings for this Landmark
@@ -178,6 +193,12 @@ namespace WorldGenerator
 		m_CellSet = CellSetLibrary::GetCellSet(cellSet);
 	}
 
+	// Sets the current cell set from a registered handle
+	void LandmarkTemplate::SetCellSet(CellSetId cellSetId)
+	{
+		m_CellSet = CellSetLibrary::GetCellSet(cellSetId);
+	}
+
 	// Sets the column range for this Landmark
 	void LandmarkTemplate::SetColumnRange(int minColumnSize, int maxColumnSize)
 	{
@@ -196,6 +217,12 @@ namespace WorldGenerator
 		m_HeightRange = std::make_pair(minElevation, maxElevation);
 	}
 
+	// Sets the engine the landmark's size, depth and exits are rolled with
+	void LandmarkTemplate::SetRandomEngine(RandomEngineType engine)
+	{
+		m_RandomEngine = engine;
+	}
+
 	// Adds a possible interactable to the Landmark
 	void LandmarkTemplate::AddInteractable(const Interactable& object)
 	{
@@ -261,6 +288,11 @@ namespace WorldGenerator
 		return m_HeightRange.second;
 	}
 
+	RandomEngineType LandmarkTemplate::GetRandomEngine() const
+	{
+		return m_RandomEngine;
+	}
+
 	std::pair<int, int> LandmarkTemplate::GetRowRange() const
 	{
 		return m_RowRange;
@@ -286,6 +318,18 @@ namespace WorldGenerator
 		return m_ExitPositions;
 	}
 
+	// Passages run through the middle rows and columns, in the order StampLandmark rolls them
+	void LandmarkTemplate::GetExitPositions(const LandmarkRoll& roll, int row, int column, std::vector<std::pair<int, int>>& exits) const
+	{
+		const std::pair<int, int> positions[4] = { std::make_pair(roll.RowCount / 2, 0), std::make_pair(roll.RowCount / 2, roll.ColumnCount - 1),
+			std::make_pair(0, roll.ColumnCount / 2), std::make_pair(roll.RowCount - 1, roll.ColumnCount / 2) };
+		for (int exit = 0; exit < 4; exit++)
+		{
+			if (roll.bExits[exit])
+				exits.push_back(std::make_pair(row + positions[exit].first, column + positions[exit].second));
+		}
+	}
+
 	// Gets all interactrables
 	const std::vector<Interactable*>& LandmarkTemplate::GetInteractables() const
 	{
@@ -293,33 +337,17 @@ namespace WorldGenerator
 	}
 
 	// Gets the border information
-	std::vector<CellType> LandmarkTemplate::GetBorderTypes(unsigned int elevation) const
+	void LandmarkTemplate::GetBorderTypes(unsigned int elevation, CellType types[8]) const
 	{
-		std::vector<CellType> types;
+		static const CellType WALL_TYPES[8] = { CellType::LeftWall, CellType::RightWall, CellType::TopWall, CellType::BottomWall,
+			CellType::TRCornerWall, CellType::TLCornerWall, CellType::BRCornerWall, CellType::BLCornerWall };
+		static const CellType CLIFF_TYPES[8] = { CellType::LeftCliff, CellType::RightCliff, CellType::TopCliff, CellType::BottomCliff,
+			CellType::TRCornerCliff, CellType::TLCornerCliff, CellType::BRCornerCliff, CellType::BLCornerCliff };
 
-		if (elevation == 0)
-		{
-			types.push_back(CellType::LeftWall);
-			types.push_back(CellType::RightWall);
-			types.push_back(CellType::TopWall);
-			types.push_back(CellType::BottomWall);
-			types.push_back(CellType::TRCornerWall);
-			types.push_back(CellType::TLCornerWall);
-			types.push_back(CellType::BRCornerWall);
-			types.push_back(CellType::BLCornerWall);
-		}
-		else
+		const CellType* source = (elevation == 0) ? WALL_TYPES : CLIFF_TYPES;
+		for (int index = 0; index < 8; index++)
 		{
-			types.push_back(CellType::LeftCliff);
-			types.push_back(CellType::RightCliff);
-			types.push_back(CellType::TopCliff);
-			types.push_back(CellType::BottomCliff);
-			types.push_back(CellType::TRCornerCliff);
-			types.push_back(CellType::TLCornerCliff);
-			types.push_back(CellType::BRCornerCliff);
-			types.push_back(CellType::BLCornerCliff);
+			types[index] = source[index];
 		}
-
-		return types;
 	}
 }
\ No newline at end of file
@@ -2,10 +2,22 @@
 // Created by Eric Marquez. All rights reserved
 
 #include "CellSetLibrary.h"
+#include "WorldGrid.h"
 #include "Interactable.h"
+#include "Random.h"
 
 namespace WorldGenerator
 {
+	// Size, elevation and exits rolled for one landmark
+	struct LandmarkRoll
+	{
+		int RowCount;
+		int ColumnCount;
+		int Depth;
+		// Which of the four passages through the middle are left open
+		bool bExits[4];
+	};
+
 	class LandmarkTemplate
 	{
 	public:
@@ -16,8 +28,19 @@ namespace WorldGenerator
 		// Generates an array for the current alloted space using a non-zero seed
 		bool GenerateLandmark(WorldGrid& grid, unsigned int seed = 0);
 
+		// Whether the cell set and size ranges are set, so landmarks can be generated
+		bool IsValid()const;
+
+		// Rolls what GenerateLandmark would build for seed, without building it
+		LandmarkRoll RollLandmark(unsigned int seed)const;
+
+		// Writes a rolled landmark into grid with its top left cell at (row, column). Every
+		// cell it covers must be on the grid. The grid's layers are left for the caller to rebuild
+		void StampLandmark(const LandmarkRoll& roll, WorldGrid& grid, int row, int column)const;
+
 		// Sets the current cell set
 		void SetCellSet(std::string cellSet);
+		void SetCellSet(CellSetId cellSetId);
 
 		// Sets the default settings for this Landmark
 		void SetDefaults(int minRowSize, int maxRowSize, int minColumnSize, int maxColumnSize, std::string cellSetName = "");
@@ -31,6 +54,9 @@ namespace WorldGenerator
 		// Sets the elevation range for this Landmark
 		void SetElevationRange(int minElevation, int maxElevation);
 
+		// Sets the engine the landmark's size, depth and exits are rolled with
+		void SetRandomEngine(RandomEngineType engine);
+
 		// Adds a possible interactable to the Landmark
 		void AddInteractable(const Interactable& object);
 
@@ -58,6 +84,9 @@ namespace WorldGenerator
 		// Gets the max column count
 		int GetMaxElevation() const;
 
+		// Gets the engine the Landmark is rolled with
+		RandomEngineType GetRandomEngine() const;
+
 		// Gets the range of the row
 		std::pair<int, int> GetRowRange()const;
 
@@ -70,16 +99,21 @@ namespace WorldGenerator
 		// Gets the exit positions generated for this Landmark
 		const std::vector<std::pair<int, int>>& GetExitPositions()const;
 
+		// Appends the middle cell of each open passage of a rolled landmark stamped with its
+		// top left cell at (row, column)
+		void GetExitPositions(const LandmarkRoll& roll, int row, int column, std::vector<std::pair<int, int>>& exits)const;
+
 		// Gets all interactrables
 		const std::vector<Interactable*>& GetInteractables()const;
 
 	private:
 
 		// Gets the border information
-		std::vector<CellType> GetBorderTypes(unsigned int elevation)const;
+		void GetBorderTypes(unsigned int elevation, CellType types[8])const;
 
 		int m_PassageWayCount;
-		CellSet* m_CellSet;
+		RandomEngineType m_RandomEngine;
+		const CellSet* m_CellSet;
 		std::pair<int, int> m_RowRange;
 		std::pair<int, int> m_ColumnRange;
 		std::pair<int, int> m_HeightRange;
@@ -0,0 +1,151 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "FlatGrid.h"
+#include "Simd.h"
+#include <cstring>
+
+namespace WorldGenerator
+{
+	// Read-only view of a cropped area of a grid scaled up by a whole factor per axis.
+	// Coordinates are mapped back to the source on every read, so nothing is allocated.
+	template<typename T>
+	class MagnifiedView
+	{
+	public:
+		// Views the whole grid
+		MagnifiedView(const FlatGrid<T>& source, std::pair<int, int> magnification)
+		{
+			m_Source = &source;
+			m_RowRange = std::make_pair(0, (int)source.RowCount());
+			m_ColumnRange = std::make_pair(0, (int)source.ColumnCount());
+			m_Magnification = magnification;
+		}
+
+		// Views the rows in [rowRange.first, rowRange.second) and columns in [columnRange.first, columnRange.second)
+		MagnifiedView(const FlatGrid<T>& source, std::pair<int, int> rowRange, std::pair<int, int> columnRange, std::pair<int, int> magnification)
+		{
+			m_Source = &source;
+			m_RowRange = rowRange;
+			m_ColumnRange = columnRange;
+			m_Magnification = magnification;
+		}
+
+		unsigned int RowCount()const
+		{
+			return (unsigned int)((m_RowRange.second - m_RowRange.first) * m_Magnification.first);
+		}
+
+		unsigned int ColumnCount()const
+		{
+			return (unsigned int)((m_ColumnRange.second - m_ColumnRange.first) * m_Magnification.second);
+		}
+
+		std::pair<int, int> GetMagnification()const
+		{
+			return m_Magnification;
+		}
+
+		// Maps a magnified position back to the source cell
+		const T& Get(int x, int y)const
+		{
+			return (*m_Source)[m_RowRange.first + x / m_Magnification.first][m_ColumnRange.first + y / m_Magnification.second];
+		}
+
+		const T& operator()(int x, int y)const
+		{
+			return Get(x, y);
+		}
+
+		// Writes the magnified cells into dest
+		void Materialize(FlatGrid<T>& dest)const
+		{
+			Materialize(dest, [](const T& value) { return value; });
+		}
+
+		// Writes the magnified cells into dest, converting each source cell once.
+		// Every source row is expanded into its first destination row, which is then
+		// block copied into the remaining rows it covers
+		template<typename U, typename Convert>
+		void Materialize(FlatGrid<U>& dest, Convert convert)const
+		{
+			dest.reshape(RowCount(), ColumnCount());
+			MaterializeRows(dest, convert, 0, m_RowRange.second - m_RowRange.first);
+		}
+
+		// Writes the magnified rows of view rows [first, last) into dest, which must already
+		// have the view's size. Lets large views be written a slice at a time
+		template<typename U, typename Convert>
+		void MaterializeRows(FlatGrid<U>& dest, Convert convert, int first, int last)const
+		{
+			const int sourceColumns = m_ColumnRange.second - m_ColumnRange.first;
+			const size_t destColumns = dest.ColumnCount();
+			if (destColumns == 0)
+				return;
+
+			const int blockSize = 256;
+			U converted[blockSize];
+			first = std::max(first, 0);
+			last = std::min(last, m_RowRange.second - m_RowRange.first);
+			for (int x = m_RowRange.first + first; x < m_RowRange.first + last; x++)
+			{
+				const T* source = (*m_Source)[x].data() + m_ColumnRange.first;
+				U* first = dest[(x - m_RowRange.first) * m_Magnification.first].data();
+
+				for (int y = 0; y < sourceColumns; y += blockSize)
+				{
+					int count = std::min(blockSize, sourceColumns - y);
+					for (int index = 0; index < count; index++)
+					{
+						converted[index] = convert(source[y + index]);
+					}
+
+					ExpandRow(converted, count, m_Magnification.second, first + (size_t)y * m_Magnification.second);
+				}
+
+				for (int copy = 1; copy < m_Magnification.first; copy++)
+				{
+					std::memcpy(first + destColumns * copy, first, destColumns * sizeof(U));
+				}
+			}
+		}
+
+	private:
+		// Repeats every value of source factor times
+		template<typename U>
+		static void ExpandRow(const U* source, int count, int factor, U* dest)
+		{
+			if (factor == 1)
+			{
+				std::memcpy(dest, source, count * sizeof(U));
+				return;
+			}
+
+			int index = 0;
+#ifdef WORLDGEN_SSE2
+			// Doubling is the common case, interleave each vector with itself
+			if (factor == 2 && (sizeof(U) == 1 || sizeof(U) == 4))
+			{
+				const int lanes = 16 / sizeof(U);
+				for (; index + lanes <= count; index += lanes)
+				{
+					__m128i values = _mm_loadu_si128((const __m128i*)(source + index));
+					__m128i low = (sizeof(U) == 1) ? _mm_unpacklo_epi8(values, values) : _mm_unpacklo_epi32(values, values);
+					__m128i high = (sizeof(U) == 1) ? _mm_unpackhi_epi8(values, values) : _mm_unpackhi_epi32(values, values);
+					_mm_storeu_si128((__m128i*)(dest + (size_t)index * 2), low);
+					_mm_storeu_si128((__m128i*)(dest + (size_t)index * 2 + lanes), high);
+				}
+			}
+#endif
+			for (; index < count; index++)
+			{
+				std::fill_n(dest + (size_t)index * factor, factor, source[index]);
+			}
+		}
+
+		const FlatGrid<T>* m_Source;
+		std::pair<int, int> m_RowRange;
+		std::pair<int, int> m_ColumnRange;
+		std::pair<int, int> m_Magnification;
+	};
+}
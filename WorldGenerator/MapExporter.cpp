@@ -0,0 +1,462 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "MapExporter.h"
+#include <cstring>
+#include <string>
+
+namespace WorldGenerator
+{
+	// Bytes collected before they are handed to the sink
+	static const size_t EXPORT_BUFFER_SIZE = 1 << 16;
+
+	// Output lines gathered per pass when transposing
+	static const int TRANSPOSE_TILE = 64;
+
+	// Largest payload of an uncompressed deflate block
+	static const size_t STORED_BLOCK_SIZE = 65535;
+
+	static unsigned int Crc32(unsigned int crc, const unsigned char* data, size_t size)
+	{
+		struct CrcTable
+		{
+			CrcTable()
+			{
+				for (unsigned int index = 0; index < 256; index++)
+				{
+					unsigned int value = index;
+					for (int bit = 0; bit < 8; bit++)
+					{
+						value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+					}
+
+					Entries[index] = value;
+				}
+			}
+
+			unsigned int Entries[256];
+		};
+
+		static const CrcTable table;
+		crc = ~crc;
+		for (size_t index = 0; index < size; index++)
+		{
+			crc = table.Entries[(crc ^ data[index]) & 0xFF] ^ (crc >> 8);
+		}
+
+		return ~crc;
+	}
+
+	static void PutBigEndian(unsigned char* out, unsigned int value)
+	{
+		out[0] = (unsigned char)(value >> 24);
+		out[1] = (unsigned char)(value >> 16);
+		out[2] = (unsigned char)(value >> 8);
+		out[3] = (unsigned char)value;
+	}
+
+	// Fixed size buffer in front of a sink
+	class ExportBuffer
+	{
+	public:
+		ExportBuffer(MapSink& sink)
+		{
+			m_Sink = &sink;
+			m_Used = 0;
+			m_bGood = true;
+			m_Buffer.resize(EXPORT_BUFFER_SIZE);
+		}
+
+		void Put(const void* data, size_t size)
+		{
+			if (m_Used + size > m_Buffer.size())
+				Flush();
+
+			if (size > m_Buffer.size())
+			{
+				m_bGood = m_bGood && m_Sink->Write((const char*)data, size);
+				return;
+			}
+
+			std::memcpy(m_Buffer.data() + m_Used, data, size);
+			m_Used += size;
+		}
+
+		bool Flush()
+		{
+			if (m_Used)
+				m_bGood = m_bGood && m_Sink->Write(m_Buffer.data(), m_Used);
+
+			m_Used = 0;
+			return m_bGood;
+		}
+
+	private:
+		MapSink* m_Sink;
+		std::vector<char> m_Buffer;
+		size_t m_Used;
+		bool m_bGood;
+	};
+
+	// Turns lines of palette indices into one of the export formats
+	class ExportEncoder
+	{
+	public:
+		ExportEncoder(MapExporter::ExportFormat format, unsigned int width, unsigned int height, const char* symbols, const unsigned char (*colours)[3], MapSink& sink) :
+			m_Output(sink)
+		{
+			m_Format = format;
+			m_Width = width;
+			m_Height = height;
+			m_Symbols = symbols;
+			m_Colours = colours;
+			m_Adler = 1;
+
+			for (unsigned int index = 0; index < CellSet::PALETTE_SIZE; index++)
+			{
+				m_Numbers[index] = std::to_string(index);
+			}
+		}
+
+		void Begin()
+		{
+			if (m_Format == MapExporter::PPM)
+			{
+				std::string header = "P6\n" + std::to_string(m_Width) + " " + std::to_string(m_Height) + "\n255\n";
+				m_Output.Put(header.data(), header.size());
+			}
+			else if (m_Format == MapExporter::PNG)
+			{
+				static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+				m_Output.Put(signature, sizeof(signature));
+
+				// 8 bit RGB, no interlacing
+				unsigned char header[13] = {};
+				PutBigEndian(header, m_Width);
+				PutBigEndian(header + 4, m_Height);
+				header[8] = 8;
+				header[9] = 2;
+				WriteChunk("IHDR", header, sizeof(header));
+
+				// zlib header for a stream of stored blocks
+				m_Deflate.push_back(0x78);
+				m_Deflate.push_back(0x01);
+			}
+		}
+
+		void WriteLine(const unsigned char* types)
+		{
+			switch (m_Format)
+			{
+			case MapExporter::ASCII:
+			{
+				m_Line.resize(m_Width + 1);
+				unsigned char* out = m_Line.data();
+				for (unsigned int index = 0; index < m_Width; index++)
+				{
+					out[index] = (unsigned char)m_Symbols[Clamp(types[index])];
+				}
+
+				out[m_Width] = '\n';
+				m_Output.Put(m_Line.data(), m_Line.size());
+				break;
+			}
+
+			case MapExporter::CSV:
+			{
+				// Values are at most two digits plus a separator
+				m_Line.resize((size_t)m_Width * 3 + 1);
+				unsigned char* out = m_Line.data();
+				for (unsigned int index = 0; index < m_Width; index++)
+				{
+					const std::string& number = m_Numbers[Clamp(types[index])];
+					if (index)
+						*out++ = ',';
+					out = std::copy(number.begin(), number.end(), out);
+				}
+
+				*out++ = '\n';
+				m_Output.Put(m_Line.data(), out - m_Line.data());
+				break;
+			}
+
+			case MapExporter::PPM:
+				m_Line.resize((size_t)m_Width * 3);
+				WritePixels(types, m_Line.data());
+				m_Output.Put(m_Line.data(), m_Line.size());
+				break;
+
+			case MapExporter::PNG:
+				// Every scanline starts with its filter type, 0 for none
+				m_Line.resize((size_t)m_Width * 3 + 1);
+				m_Line[0] = 0;
+				WritePixels(types, m_Line.data() + 1);
+				AppendStored(m_Line.data(), m_Line.size());
+				break;
+			}
+		}
+
+		bool End()
+		{
+			if (m_Format == MapExporter::PNG)
+			{
+				// An empty final block closes the deflate stream, then the checksum of the raw data
+				const unsigned char last[5] = { 0x01, 0x00, 0x00, 0xFF, 0xFF };
+				m_Deflate.insert(m_Deflate.end(), last, last + sizeof(last));
+				unsigned char adler[4];
+				PutBigEndian(adler, m_Adler);
+				m_Deflate.insert(m_Deflate.end(), adler, adler + sizeof(adler));
+
+				WriteChunk("IDAT", m_Deflate.data(), m_Deflate.size());
+				WriteChunk("IEND", nullptr, 0);
+			}
+
+			return m_Output.Flush();
+		}
+
+	private:
+		static unsigned char Clamp(unsigned char type)
+		{
+			return (type < CellSet::PALETTE_SIZE) ? type : CellSet::GetPaletteIndex(CellType::Empty);
+		}
+
+		void WritePixels(const unsigned char* types, unsigned char* out)
+		{
+			for (unsigned int index = 0; index < m_Width; index++)
+			{
+				const unsigned char* colour = m_Colours[Clamp(types[index])];
+				out[index * 3] = colour[0];
+				out[index * 3 + 1] = colour[1];
+				out[index * 3 + 2] = colour[2];
+			}
+		}
+
+		// Adds data to the deflate stream as non-final stored blocks, emitting an IDAT chunk whenever the buffer fills
+		void AppendStored(const unsigned char* data, size_t size)
+		{
+			UpdateAdler(data, size);
+			while (size)
+			{
+				size_t count = std::min(size, STORED_BLOCK_SIZE);
+				unsigned char header[5] = { 0x00, (unsigned char)count, (unsigned char)(count >> 8), (unsigned char)~count, (unsigned char)(~count >> 8) };
+				m_Deflate.insert(m_Deflate.end(), header, header + sizeof(header));
+				m_Deflate.insert(m_Deflate.end(), data, data + count);
+				data += count;
+				size -= count;
+
+				if (m_Deflate.size() >= EXPORT_BUFFER_SIZE)
+				{
+					WriteChunk("IDAT", m_Deflate.data(), m_Deflate.size());
+					m_Deflate.clear();
+				}
+			}
+		}
+
+		void UpdateAdler(const unsigned char* data, size_t size)
+		{
+			unsigned int low = m_Adler & 0xFFFF;
+			unsigned int high = m_Adler >> 16;
+			while (size)
+			{
+				// 5552 bytes is the most that can be summed before the 32 bit sums could overflow
+				size_t count = std::min(size, (size_t)5552);
+				for (size_t index = 0; index < count; index++)
+				{
+					low += data[index];
+					high += low;
+				}
+
+				low %= 65521;
+				high %= 65521;
+				data += count;
+				size -= count;
+			}
+
+			m_Adler = (high << 16) | low;
+		}
+
+		void WriteChunk(const char* type, const unsigned char* data, size_t size)
+		{
+			unsigned char length[4];
+			PutBigEndian(length, (unsigned int)size);
+			m_Output.Put(length, sizeof(length));
+			m_Output.Put(type, 4);
+			if (size)
+				m_Output.Put(data, size);
+
+			unsigned char crc[4];
+			PutBigEndian(crc, Crc32(Crc32(0, (const unsigned char*)type, 4), data, size));
+			m_Output.Put(crc, sizeof(crc));
+		}
+
+		MapExporter::ExportFormat m_Format;
+		unsigned int m_Width;
+		unsigned int m_Height;
+		const char* m_Symbols;
+		const unsigned char (*m_Colours)[3];
+		std::string m_Numbers[CellSet::PALETTE_SIZE];
+		std::vector<unsigned char> m_Line;
+		std::vector<unsigned char> m_Deflate;
+		unsigned int m_Adler;
+		ExportBuffer m_Output;
+	};
+
+	StreamSink::StreamSink(std::ostream& stream)
+	{
+		m_Stream = &stream;
+	}
+
+	bool StreamSink::Write(const char* data, size_t size)
+	{
+		m_Stream->write(data, size);
+		return (bool)*m_Stream;
+	}
+
+	FileSink::FileSink(const std::string& path)
+	{
+		m_File = std::fopen(path.c_str(), "wb");
+	}
+
+	FileSink::~FileSink()
+	{
+		if (m_File)
+			std::fclose(m_File);
+	}
+
+	bool FileSink::IsOpen() const
+	{
+		return m_File != nullptr;
+	}
+
+	bool FileSink::Write(const char* data, size_t size)
+	{
+		return m_File && std::fwrite(data, 1, size, m_File) == size;
+	}
+
+	MapExporter::MapExporter()
+	{
+		m_bTransposed = false;
+		for (unsigned int index = 0; index < CellSet::PALETTE_SIZE; index++)
+		{
+			m_Symbols[index] = ' ';
+			SetColour((CellType)index, 0, 0, 0);
+		}
+
+		SetSymbol(CellType::Ground, '.');
+		SetSymbol(CellType::LeftWall, '|');
+		SetSymbol(CellType::RightWall, '|');
+		SetSymbol(CellType::TopWall, '-');
+		SetSymbol(CellType::BottomWall, '-');
+		SetSymbol(CellType::TRCornerWall, '\\');
+		SetSymbol(CellType::BLCornerWall, '\\');
+		SetSymbol(CellType::TLCornerWall, '/');
+		SetSymbol(CellType::BRCornerWall, '/');
+
+		SetColour(CellType::Ground, 196, 170, 120);
+		for (unsigned int index = (unsigned int)CellType::LeftWall; index <= (unsigned int)CellType::BLCornerWall; index++)
+		{
+			SetColour((CellType)index, 96, 96, 104);
+		}
+
+		for (unsigned int index = (unsigned int)CellType::LeftCliff; index <= (unsigned int)CellType::BLCornerCliff; index++)
+		{
+			SetColour((CellType)index, 112, 80, 56);
+		}
+
+		SetColour(CellType::Interactable, 230, 200, 40);
+	}
+
+	bool MapExporter::Export(const WorldGrid& grid, ExportFormat format, MapSink& sink) const
+	{
+		const Cell* cells = grid.data();
+		const size_t stride = grid.Stride();
+		return ExportLines(grid.RowCount(), grid.ColumnCount(), [cells, stride](int x, int y) { return CellSet::GetPaletteIndex(cells[x * stride + y].Type); }, format, sink);
+	}
+
+	bool MapExporter::Export(const PaletteGrid& grid, ExportFormat format, MapSink& sink) const
+	{
+		const unsigned char* cells = grid.data();
+		const size_t stride = grid.Stride();
+		return ExportLines(grid.RowCount(), grid.ColumnCount(), [cells, stride](int x, int y) { return cells[x * stride + y]; }, format, sink);
+	}
+
+	template<typename TypeOf>
+	bool MapExporter::ExportLines(unsigned int rows, unsigned int columns, TypeOf typeOf, ExportFormat format, MapSink& sink) const
+	{
+		const unsigned int width = m_bTransposed ? rows : columns;
+		const unsigned int height = m_bTransposed ? columns : rows;
+		ExportEncoder encoder(format, width, height, m_Symbols, m_Colours, sink);
+		encoder.Begin();
+
+		if (!m_bTransposed)
+		{
+			std::vector<unsigned char> line(width);
+			for (unsigned int x = 0; x < rows; x++)
+			{
+				for (unsigned int y = 0; y < columns; y++)
+				{
+					line[y] = typeOf(x, y);
+				}
+
+				encoder.WriteLine(line.data());
+			}
+
+			return encoder.End();
+		}
+
+		// Gather a tile of output lines at a time. Each source row is read once per tile as a short
+		// contiguous run, and the tile's lines stay in cache while they fill up
+		std::vector<unsigned char> lines((size_t)TRANSPOSE_TILE * width);
+		for (unsigned int first = 0; first < height; first += TRANSPOSE_TILE)
+		{
+			const int count = std::min((int)(height - first), TRANSPOSE_TILE);
+			const int top = (int)columns - 1 - (int)first;
+			for (unsigned int x = 0; x < rows; x++)
+			{
+				for (int line = 0; line < count; line++)
+				{
+					lines[(size_t)line * width + x] = typeOf(x, top - line);
+				}
+			}
+
+			for (int line = 0; line < count; line++)
+			{
+				encoder.WriteLine(lines.data() + (size_t)line * width);
+			}
+		}
+
+		return encoder.End();
+	}
+
+	void MapExporter::SetTransposed(bool bTransposed)
+	{
+		m_bTransposed = bTransposed;
+	}
+
+	bool MapExporter::IsTransposed() const
+	{
+		return m_bTransposed;
+	}
+
+	void MapExporter::SetSymbol(CellType type, char symbol)
+	{
+		m_Symbols[CellSet::GetPaletteIndex(type)] = symbol;
+	}
+
+	char MapExporter::GetSymbol(CellType type) const
+	{
+		return m_Symbols[CellSet::GetPaletteIndex(type)];
+	}
+
+	void MapExporter::SetColour(CellType type, unsigned char red, unsigned char green, unsigned char blue)
+	{
+		unsigned char* colour = m_Colours[CellSet::GetPaletteIndex(type)];
+		colour[0] = red;
+		colour[1] = green;
+		colour[2] = blue;
+	}
+
+	const unsigned char* MapExporter::GetColour(CellType type) const
+	{
+		return m_Colours[CellSet::GetPaletteIndex(type)];
+	}
+}
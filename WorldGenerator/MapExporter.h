@@ -0,0 +1,87 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "PaletteGrid.h"
+#include <ostream>
+#include <cstdio>
+
+namespace WorldGenerator
+{
+	// Destination for exported bytes. Exporters hand over data in bounded pieces
+	class MapSink
+	{
+	public:
+		virtual ~MapSink() = default;
+
+		virtual bool Write(const char* data, size_t size) = 0;
+	};
+
+	class StreamSink : public MapSink
+	{
+	public:
+		StreamSink(std::ostream& stream);
+
+		bool Write(const char* data, size_t size) override;
+
+	private:
+		std::ostream* m_Stream;
+	};
+
+	class FileSink : public MapSink
+	{
+	public:
+		FileSink(const std::string& path);
+		~FileSink();
+
+		FileSink(const FileSink&) = delete;
+		FileSink& operator=(const FileSink&) = delete;
+
+		bool IsOpen()const;
+		bool Write(const char* data, size_t size) override;
+
+	private:
+		FILE* m_File;
+	};
+
+	// Writes maps out line by line through a fixed size buffer, so memory use does not
+	// grow with the map. Cell types are turned into characters or colours through
+	// per-type tables that can be changed before exporting.
+	class MapExporter
+	{
+	public:
+		enum ExportFormat
+		{
+			ASCII = 0,
+			// Binary RGB pixmap
+			PPM,
+			// RGB image with uncompressed deflate blocks
+			PNG,
+			// Comma separated CellType values
+			CSV,
+		};
+
+		MapExporter();
+
+		bool Export(const WorldGrid& grid, ExportFormat format, MapSink& sink)const;
+		bool Export(const PaletteGrid& grid, ExportFormat format, MapSink& sink)const;
+
+		// Emits column y as line ColumnCount - 1 - y instead of row x as line x, which is how
+		// PrintGrid has always drawn maps. Columns are gathered in cache sized tiles
+		void SetTransposed(bool bTransposed);
+		bool IsTransposed()const;
+
+		void SetSymbol(CellType type, char symbol);
+		char GetSymbol(CellType type)const;
+
+		void SetColour(CellType type, unsigned char red, unsigned char green, unsigned char blue);
+		const unsigned char* GetColour(CellType type)const;
+
+	private:
+		template<typename TypeOf>
+		bool ExportLines(unsigned int rows, unsigned int columns, TypeOf typeOf, ExportFormat format, MapSink& sink)const;
+
+		bool m_bTransposed;
+		char m_Symbols[CellSet::PALETTE_SIZE];
+		unsigned char m_Colours[CellSet::PALETTE_SIZE][3];
+	};
+}
@@ -0,0 +1,545 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "MapFile.h"
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WorldGenerator
+{
+	static const char MAGIC[4] = { 'W', 'G', 'M', 'P' };
+
+	// Longest run a single RLE entry can hold
+	static const unsigned int MAX_RUN = 255;
+
+	MapFileInfo::MapFileInfo()
+	{
+		Seed = 0;
+		MaxWalkers = 0;
+		MaxPathLength = 0;
+		PathDivergencePercent = 0;
+		Magnification = std::make_pair(1, 1);
+		RandomEngine = RandomEngineType::Xoshiro256;
+		MapSize = std::make_pair(0, 0);
+		StartPosition = std::make_pair(0, 0);
+		bAutoTiling = false;
+		bPerWalkerStreams = false;
+	}
+
+	MapFileInfo::MapFileInfo(const Generator& generator, unsigned long long seed, std::pair<int, int> startPosition)
+	{
+		CellSetName = generator.GetCellSetName();
+		Seed = seed;
+		MaxWalkers = generator.GetMaxWalkers();
+		MaxPathLength = generator.GetMaxPathLength();
+		PathDivergencePercent = generator.GetPathDivergencePercent();
+		Magnification = generator.GetMagnification();
+		RandomEngine = generator.GetRandomEngine();
+		MapSize = std::make_pair(generator.GetMapRows(), generator.GetMapColumns());
+		StartPosition = startPosition;
+		bAutoTiling = generator.IsAutoTiling();
+		bPerWalkerStreams = generator.GetWorkerThreads() != 0;
+	}
+
+	// Stores count elements as (run length, element) pairs
+	static void EncodeRuns(const unsigned char* data, size_t count, unsigned int elementBytes, std::vector<unsigned char>& out)
+	{
+		out.clear();
+		size_t index = 0;
+		while (index < count)
+		{
+			const unsigned char* element = data + index * elementBytes;
+			unsigned int run = 1;
+			while (run < MAX_RUN && index + run < count && std::memcmp(element, data + (index + run) * elementBytes, elementBytes) == 0)
+			{
+				run++;
+			}
+
+			out.push_back((unsigned char)run);
+			out.insert(out.end(), element, element + elementBytes);
+			index += run;
+		}
+	}
+
+	// Expands exactly count elements into out. Fails on streams that are cut short or overrun
+	static bool DecodeRuns(const unsigned char* data, size_t size, unsigned int elementBytes, size_t count, unsigned char* out)
+	{
+		size_t written = 0;
+		size_t position = 0;
+		while (written < count)
+		{
+			if (position + 1 + elementBytes > size)
+				return false;
+
+			unsigned int run = data[position];
+			const unsigned char* element = data + position + 1;
+			if (run == 0 || written + run > count)
+				return false;
+
+			for (unsigned int index = 0; index < run; index++)
+			{
+				std::memcpy(out + (written + index) * elementBytes, element, elementBytes);
+			}
+
+			written += run;
+			position += 1 + elementBytes;
+		}
+
+		return true;
+	}
+
+	// Finds one element of an RLE stream without expanding it
+	static const unsigned char* FindRun(const unsigned char* data, size_t size, unsigned int elementBytes, size_t target)
+	{
+		size_t first = 0;
+		for (size_t position = 0; position + 1 + elementBytes <= size; position += 1 + elementBytes)
+		{
+			first += data[position];
+			if (target < first)
+				return data + position + 1;
+		}
+
+		return nullptr;
+	}
+
+	static bool WriteMap(const std::string& path, const unsigned char* cells, int rows, int columns, unsigned int cellBytes, const Cell* palette, const MapFileInfo& info, bool bCompress, int chunkSize)
+	{
+		if (rows < 0 || columns < 0 || chunkSize <= 0)
+			return false;
+
+		// Value initialization zeroes the reserved bytes and padding too
+		MapFileHeader header = MapFileHeader();
+		std::memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+		header.Version = MapFile::VERSION;
+		header.Rows = rows;
+		header.Columns = columns;
+		header.ChunkSize = chunkSize;
+		header.CellBytes = cellBytes;
+		header.Seed = info.Seed;
+		std::memcpy(header.CellSetName, info.CellSetName.data(), std::min(info.CellSetName.size(), sizeof(header.CellSetName) - 1));
+		header.MaxWalkers = info.MaxWalkers;
+		header.MaxPathLength = info.MaxPathLength;
+		header.PathDivergencePercent = info.PathDivergencePercent;
+		header.MagnificationRows = info.Magnification.first;
+		header.MagnificationColumns = info.Magnification.second;
+		header.RandomEngine = (std::uint32_t)info.RandomEngine;
+		header.MapRows = info.MapSize.first;
+		header.MapColumns = info.MapSize.second;
+		header.StartRow = info.StartPosition.first;
+		header.StartColumn = info.StartPosition.second;
+		header.Flags = (info.bAutoTiling ? MapFile::AUTO_TILING : 0) | (info.bPerWalkerStreams ? MapFile::PER_WALKER_STREAMS : 0);
+		header.PaletteSize = CellSet::PALETTE_SIZE;
+		for (unsigned int index = 0; index < CellSet::PALETTE_SIZE; index++)
+		{
+			header.Palette[index] = palette ? palette[index] : Cell();
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		file.write((const char*)&header, sizeof(header));
+		std::uint64_t position = sizeof(header);
+
+		const int chunkRows = (rows + chunkSize - 1) / chunkSize;
+		const int chunkColumns = (columns + chunkSize - 1) / chunkSize;
+		std::vector<MapFileChunk> chunks((size_t)chunkRows * chunkColumns);
+		std::vector<unsigned char> raw;
+		std::vector<unsigned char> encoded;
+		const char padding[8] = {};
+
+		for (int chunkRow = 0; chunkRow < chunkRows; chunkRow++)
+		{
+			for (int chunkColumn = 0; chunkColumn < chunkColumns; chunkColumn++)
+			{
+				// Gather the chunk's rows into one contiguous block
+				const int firstRow = chunkRow * chunkSize;
+				const int firstColumn = chunkColumn * chunkSize;
+				const int height = std::min(chunkSize, rows - firstRow);
+				const size_t width = std::min(chunkSize, columns - firstColumn);
+				raw.resize(height * width * cellBytes);
+				for (int x = 0; x < height; x++)
+				{
+					std::memcpy(raw.data() + x * width * cellBytes, cells + ((size_t)(firstRow + x) * columns + firstColumn) * cellBytes, width * cellBytes);
+				}
+
+				MapFileChunk& chunk = chunks[(size_t)chunkRow * chunkColumns + chunkColumn];
+				const std::vector<unsigned char>* payload = &raw;
+				chunk.Encoding = MapFile::RAW;
+				if (bCompress)
+				{
+					EncodeRuns(raw.data(), height * width, cellBytes, encoded);
+					if (encoded.size() < raw.size())
+					{
+						payload = &encoded;
+						chunk.Encoding = MapFile::RLE;
+					}
+				}
+
+				file.write(padding, (8 - position % 8) % 8);
+				position += (8 - position % 8) % 8;
+				chunk.Offset = position;
+				chunk.Size = (std::uint32_t)payload->size();
+				file.write((const char*)payload->data(), payload->size());
+				position += payload->size();
+			}
+		}
+
+		file.write(padding, (8 - position % 8) % 8);
+		position += (8 - position % 8) % 8;
+		header.ChunkIndexOffset = position;
+		file.write((const char*)chunks.data(), chunks.size() * sizeof(MapFileChunk));
+
+		file.seekp(0);
+		file.write((const char*)&header, sizeof(header));
+		return (bool)file;
+	}
+
+	MapFile::MapFile()
+	{
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Header = nullptr;
+		m_Chunks = nullptr;
+#ifdef _WIN32
+		m_FileHandle = nullptr;
+		m_MappingHandle = nullptr;
+#endif
+	}
+
+	MapFile::~MapFile()
+	{
+		Close();
+	}
+
+	bool MapFile::Write(const std::string& path, const WorldGrid& grid, const MapFileInfo& info, bool bCompress, int chunkSize)
+	{
+		const CellSet* cellSet = CellSetLibrary::GetCellSet(info.CellSetName);
+		return WriteMap(path, (const unsigned char*)grid.data(), grid.RowCount(), grid.ColumnCount(), sizeof(Cell), cellSet ? cellSet->GetPalette() : nullptr, info, bCompress, chunkSize);
+	}
+
+	bool MapFile::Write(const std::string& path, const PaletteGrid& grid, const MapFileInfo& info, bool bCompress, int chunkSize)
+	{
+		const CellSet* cellSet = grid.GetCellSet();
+		return WriteMap(path, grid.data(), grid.RowCount(), grid.ColumnCount(), 1, cellSet ? cellSet->GetPalette() : nullptr, info, bCompress, chunkSize);
+	}
+
+	bool MapFile::Open(const std::string& path)
+	{
+		Close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		HANDLE mapping = nullptr;
+		if (GetFileSizeEx(file, &size) && size.QuadPart >= (LONGLONG)sizeof(MapFileHeader))
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		m_FileHandle = file;
+		m_MappingHandle = mapping;
+		if (!data)
+		{
+			Close();
+			return false;
+		}
+
+		m_Data = (const unsigned char*)data;
+		m_Size = (size_t)size.QuadPart;
+#else
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat status;
+		void* data = MAP_FAILED;
+		if (fstat(file, &status) == 0 && status.st_size >= (off_t)sizeof(MapFileHeader))
+			data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+		// The mapping stays valid after the descriptor is closed
+		close(file);
+		if (data == MAP_FAILED)
+			return false;
+
+		m_Data = (const unsigned char*)data;
+		m_Size = (size_t)status.st_size;
+#endif
+
+		// Check everything the accessors rely on once, so they can read without checks
+		const MapFileHeader* header = (const MapFileHeader*)m_Data;
+		bool bValid = std::memcmp(header->Magic, MAGIC, sizeof(MAGIC)) == 0 && header->Version == VERSION &&
+			header->ChunkSize > 0 && (header->CellBytes == 1 || header->CellBytes == sizeof(Cell)) && header->PaletteSize == CellSet::PALETTE_SIZE;
+
+		m_Header = header;
+		const size_t chunkCount = bValid ? (size_t)GetChunkRowCount() * GetChunkColumnCount() : 0;
+		bValid = bValid && header->ChunkIndexOffset % 8 == 0 && header->ChunkIndexOffset <= m_Size &&
+			chunkCount <= (m_Size - header->ChunkIndexOffset) / sizeof(MapFileChunk);
+
+		if (bValid)
+		{
+			m_Chunks = (const MapFileChunk*)(m_Data + header->ChunkIndexOffset);
+			for (int chunkRow = 0; bValid && chunkRow < GetChunkRowCount(); chunkRow++)
+			{
+				for (int chunkColumn = 0; bValid && chunkColumn < GetChunkColumnCount(); chunkColumn++)
+				{
+					const MapFileChunk& chunk = GetChunkEntry(chunkRow, chunkColumn);
+					std::pair<int, int> dimensions = GetChunkDimensions(chunkRow, chunkColumn);
+					size_t rawSize = (size_t)dimensions.first * dimensions.second * header->CellBytes;
+
+					bValid = chunk.Offset % 8 == 0 && chunk.Offset <= m_Size && chunk.Size <= m_Size - chunk.Offset &&
+						((chunk.Encoding == RAW && chunk.Size == rawSize) || chunk.Encoding == RLE);
+				}
+			}
+		}
+
+		if (!bValid)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MapFile::Close()
+	{
+#ifdef _WIN32
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+		if (m_MappingHandle)
+			CloseHandle(m_MappingHandle);
+		if (m_FileHandle)
+			CloseHandle(m_FileHandle);
+
+		m_FileHandle = nullptr;
+		m_MappingHandle = nullptr;
+#else
+		if (m_Data)
+			munmap((void*)m_Data, m_Size);
+#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Header = nullptr;
+		m_Chunks = nullptr;
+	}
+
+	bool MapFile::IsOpen() const
+	{
+		return m_Data != nullptr;
+	}
+
+	const MapFileHeader& MapFile::GetHeader() const
+	{
+		return *m_Header;
+	}
+
+	MapFileInfo MapFile::GetInfo() const
+	{
+		MapFileInfo info;
+		info.CellSetName = std::string(m_Header->CellSetName, strnlen(m_Header->CellSetName, sizeof(m_Header->CellSetName)));
+		info.Seed = m_Header->Seed;
+		info.MaxWalkers = m_Header->MaxWalkers;
+		info.MaxPathLength = m_Header->MaxPathLength;
+		info.PathDivergencePercent = m_Header->PathDivergencePercent;
+		info.Magnification = std::make_pair(m_Header->MagnificationRows, m_Header->MagnificationColumns);
+		info.RandomEngine = (RandomEngineType)m_Header->RandomEngine;
+		info.MapSize = std::make_pair(m_Header->MapRows, m_Header->MapColumns);
+		info.StartPosition = std::make_pair(m_Header->StartRow, m_Header->StartColumn);
+		info.bAutoTiling = (m_Header->Flags & AUTO_TILING) != 0;
+		info.bPerWalkerStreams = (m_Header->Flags & PER_WALKER_STREAMS) != 0;
+		return info;
+	}
+
+	int MapFile::RowCount() const
+	{
+		return m_Header ? (int)m_Header->Rows : 0;
+	}
+
+	int MapFile::ColumnCount() const
+	{
+		return m_Header ? (int)m_Header->Columns : 0;
+	}
+
+	int MapFile::GetChunkSize() const
+	{
+		return m_Header ? (int)m_Header->ChunkSize : 0;
+	}
+
+	int MapFile::GetChunkRowCount() const
+	{
+		return m_Header ? (int)(((unsigned long long)m_Header->Rows + m_Header->ChunkSize - 1) / m_Header->ChunkSize) : 0;
+	}
+
+	int MapFile::GetChunkColumnCount() const
+	{
+		return m_Header ? (int)(((unsigned long long)m_Header->Columns + m_Header->ChunkSize - 1) / m_Header->ChunkSize) : 0;
+	}
+
+	std::pair<int, int> MapFile::GetChunkDimensions(int chunkRow, int chunkColumn) const
+	{
+		int size = GetChunkSize();
+		return std::make_pair(std::min(size, RowCount() - chunkRow * size), std::min(size, ColumnCount() - chunkColumn * size));
+	}
+
+	bool MapFile::IsChunkCompressed(int chunkRow, int chunkColumn) const
+	{
+		return GetChunkEntry(chunkRow, chunkColumn).Encoding != RAW;
+	}
+
+	const unsigned char* MapFile::GetChunkData(int chunkRow, int chunkColumn) const
+	{
+		const MapFileChunk& chunk = GetChunkEntry(chunkRow, chunkColumn);
+		return (chunk.Encoding == RAW) ? m_Data + chunk.Offset : nullptr;
+	}
+
+	bool MapFile::ReadChunk(int chunkRow, int chunkColumn, unsigned char* out) const
+	{
+		const MapFileChunk& chunk = GetChunkEntry(chunkRow, chunkColumn);
+		std::pair<int, int> dimensions = GetChunkDimensions(chunkRow, chunkColumn);
+		size_t count = (size_t)dimensions.first * dimensions.second;
+
+		if (chunk.Encoding == RAW)
+		{
+			std::memcpy(out, m_Data + chunk.Offset, count * m_Header->CellBytes);
+			return true;
+		}
+
+		return DecodeRuns(m_Data + chunk.Offset, chunk.Size, m_Header->CellBytes, count, out);
+	}
+
+	Cell MapFile::GetCell(int x, int y) const
+	{
+		if (!IsOpen() || x < 0 || x >= RowCount() || y < 0 || y >= ColumnCount())
+			return Cell();
+
+		const int size = GetChunkSize();
+		const MapFileChunk& chunk = GetChunkEntry(x / size, y / size);
+		size_t index = (size_t)(x % size) * GetChunkDimensions(x / size, y / size).second + y % size;
+
+		const unsigned char* stored = (chunk.Encoding == RAW) ? m_Data + chunk.Offset + index * m_Header->CellBytes :
+			FindRun(m_Data + chunk.Offset, chunk.Size, m_Header->CellBytes, index);
+
+		return stored ? DecodeCell(stored) : Cell();
+	}
+
+	bool MapFile::Read(WorldGrid& grid) const
+	{
+		return ReadWindow(grid, 0, 0, RowCount(), ColumnCount());
+	}
+
+	bool MapFile::Read(PaletteGrid& grid, const CellSet* cellSet) const
+	{
+		if (!IsOpen() || m_Header->CellBytes != 1)
+			return false;
+
+		grid.SetCellSet(cellSet ? cellSet : CellSetLibrary::GetCellSet(GetInfo().CellSetName));
+		grid.reshape(RowCount(), ColumnCount());
+
+		const int size = GetChunkSize();
+		std::vector<unsigned char> scratch;
+		for (int chunkRow = 0; chunkRow < GetChunkRowCount(); chunkRow++)
+		{
+			for (int chunkColumn = 0; chunkColumn < GetChunkColumnCount(); chunkColumn++)
+			{
+				std::pair<int, int> dimensions = GetChunkDimensions(chunkRow, chunkColumn);
+				const unsigned char* stored = GetChunkData(chunkRow, chunkColumn);
+				if (!stored)
+				{
+					scratch.resize((size_t)dimensions.first * dimensions.second);
+					if (!ReadChunk(chunkRow, chunkColumn, scratch.data()))
+						return false;
+
+					stored = scratch.data();
+				}
+
+				for (int x = 0; x < dimensions.first; x++)
+				{
+					std::memcpy(grid[chunkRow * size + x].data() + chunkColumn * size, stored + (size_t)x * dimensions.second, dimensions.second);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool MapFile::ReadWindow(WorldGrid& grid, int row, int column, int rows, int columns) const
+	{
+		if (!IsOpen() || rows < 0 || columns < 0)
+			return false;
+
+		grid.reshape(rows, columns);
+		grid.fill(Cell());
+
+		// Part of the window that lies on the map
+		const int rowFirst = std::max(row, 0);
+		const int rowLast = std::min(row + rows, RowCount());
+		const int columnFirst = std::max(column, 0);
+		const int columnLast = std::min(column + columns, ColumnCount());
+
+		const int size = GetChunkSize();
+		const unsigned int cellBytes = m_Header->CellBytes;
+		std::vector<unsigned char> scratch;
+		for (int chunkRow = rowFirst / size; rowFirst < rowLast && chunkRow <= (rowLast - 1) / size; chunkRow++)
+		{
+			for (int chunkColumn = columnFirst / size; columnFirst < columnLast && chunkColumn <= (columnLast - 1) / size; chunkColumn++)
+			{
+				std::pair<int, int> dimensions = GetChunkDimensions(chunkRow, chunkColumn);
+				const unsigned char* stored = GetChunkData(chunkRow, chunkColumn);
+				if (!stored)
+				{
+					scratch.resize((size_t)dimensions.first * dimensions.second * cellBytes);
+					if (!ReadChunk(chunkRow, chunkColumn, scratch.data()))
+						return false;
+
+					stored = scratch.data();
+				}
+
+				const int top = std::max(rowFirst, chunkRow * size);
+				const int bottom = std::min(rowLast, chunkRow * size + dimensions.first);
+				const int left = std::max(columnFirst, chunkColumn * size);
+				const int right = std::min(columnLast, chunkColumn * size + dimensions.second);
+				for (int x = top; x < bottom; x++)
+				{
+					const unsigned char* source = stored + ((size_t)(x - chunkRow * size) * dimensions.second + (left - chunkColumn * size)) * cellBytes;
+					Cell* dest = grid[x - row].data() + (left - column);
+					for (int index = 0; index < right - left; index++)
+					{
+						dest[index] = DecodeCell(source + (size_t)index * cellBytes);
+					}
+				}
+			}
+		}
+
+		grid.RebuildLayers();
+		return true;
+	}
+
+	const MapFileChunk& MapFile::GetChunkEntry(int chunkRow, int chunkColumn) const
+	{
+		return m_Chunks[(size_t)chunkRow * GetChunkColumnCount() + chunkColumn];
+	}
+
+	Cell MapFile::DecodeCell(const unsigned char* stored) const
+	{
+		if (m_Header->CellBytes == 1)
+			return (*stored < CellSet::PALETTE_SIZE) ? m_Header->Palette[*stored] : Cell();
+
+		Cell cell;
+		std::memcpy(&cell, stored, sizeof(Cell));
+		return cell;
+	}
+}
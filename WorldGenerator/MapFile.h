@@ -0,0 +1,158 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "Generator.h"
+#include <cstdint>
+#include <string>
+
+namespace WorldGenerator
+{
+	// Settings a map was generated with, stored in the file header
+	struct MapFileInfo
+	{
+		MapFileInfo();
+
+		// Copies the settings of generator and the start the walk began at
+		MapFileInfo(const Generator& generator, unsigned long long seed, std::pair<int, int> startPosition = std::make_pair(0, 0));
+
+		std::string CellSetName;
+		unsigned long long Seed;
+		int MaxWalkers;
+		int MaxPathLength;
+		int PathDivergencePercent;
+		std::pair<int, int> Magnification;
+		RandomEngineType RandomEngine;
+		// Rows and columns the generator's map size was set to, before cropping
+		std::pair<int, int> MapSize;
+		std::pair<int, int> StartPosition;
+		bool bAutoTiling;
+		// Walkers drew from their own streams, as they do with worker threads
+		bool bPerWalkerStreams;
+	};
+
+	// On-disk header. Files are written in the byte order of the machine that wrote them
+	struct MapFileHeader
+	{
+		char Magic[4];
+		std::uint32_t Version;
+		std::uint32_t Rows;
+		std::uint32_t Columns;
+		std::uint32_t ChunkSize;
+		// 1 when cells are stored as palette indices, sizeof(Cell) when they are stored whole
+		std::uint32_t CellBytes;
+		std::uint64_t Seed;
+		std::uint64_t ChunkIndexOffset;
+		char CellSetName[32];
+		std::int32_t MaxWalkers;
+		std::int32_t MaxPathLength;
+		std::int32_t PathDivergencePercent;
+		std::int32_t MagnificationRows;
+		std::int32_t MagnificationColumns;
+		std::uint32_t PaletteSize;
+		Cell Palette[CellSet::PALETTE_SIZE];
+		// RandomEngineType the walk drew from
+		std::uint32_t RandomEngine;
+		std::int32_t MapRows;
+		std::int32_t MapColumns;
+		std::int32_t StartRow;
+		std::int32_t StartColumn;
+		// MapFile::HeaderFlags
+		std::uint32_t Flags;
+		std::uint8_t Reserved[12];
+	};
+
+	// One entry per chunk, row-major. Offsets are 8 byte aligned so stored cells can be read in place
+	struct MapFileChunk
+	{
+		std::uint64_t Offset;
+		std::uint32_t Size;
+		std::uint32_t Encoding;
+	};
+
+	static_assert(sizeof(MapFileHeader) == 216, "MapFileHeader layout is part of the file format");
+	static_assert(sizeof(MapFileChunk) == 16, "MapFileChunk layout is part of the file format");
+
+	// Versioned binary map file. The map is split into square chunks, each stored raw or
+	// run-length encoded, with an index of chunk offsets after the payloads.
+	// Open maps the file into memory, so only the pages of the chunks that are read get loaded
+	// and raw chunks are served straight out of the mapping.
+	class MapFile
+	{
+	public:
+		static const std::uint32_t VERSION = 2;
+		static const int DEFAULT_CHUNK_SIZE = 64;
+
+		enum ChunkEncoding
+		{
+			RAW = 0,
+			RLE,
+		};
+
+		enum HeaderFlags
+		{
+			AUTO_TILING = 1,
+			PER_WALKER_STREAMS = 2,
+		};
+
+		MapFile();
+		~MapFile();
+
+		MapFile(const MapFile&) = delete;
+		MapFile& operator=(const MapFile&) = delete;
+
+		// Writes full cells. The header palette comes from the cell set named in info, when it exists
+		static bool Write(const std::string& path, const WorldGrid& grid, const MapFileInfo& info, bool bCompress = false, int chunkSize = DEFAULT_CHUNK_SIZE);
+
+		// Writes one palette index per cell along with the grid's palette
+		static bool Write(const std::string& path, const PaletteGrid& grid, const MapFileInfo& info, bool bCompress = false, int chunkSize = DEFAULT_CHUNK_SIZE);
+
+		// Maps the file and checks its header and chunk index
+		bool Open(const std::string& path);
+		void Close();
+		bool IsOpen()const;
+
+		const MapFileHeader& GetHeader()const;
+		MapFileInfo GetInfo()const;
+		int RowCount()const;
+		int ColumnCount()const;
+		int GetChunkSize()const;
+		int GetChunkRowCount()const;
+		int GetChunkColumnCount()const;
+
+		// Rows and columns covered by a chunk. Chunks on the far edges may be smaller than the chunk size
+		std::pair<int, int> GetChunkDimensions(int chunkRow, int chunkColumn)const;
+
+		bool IsChunkCompressed(int chunkRow, int chunkColumn)const;
+
+		// Stored cells of a raw chunk, row-major with CellBytes per cell. Returns nullptr for compressed chunks
+		const unsigned char* GetChunkData(int chunkRow, int chunkColumn)const;
+
+		// Decodes a chunk into out, which must hold its rows * columns * CellBytes bytes
+		bool ReadChunk(int chunkRow, int chunkColumn, unsigned char* out)const;
+
+		// Decodes a single cell, reading only the chunk that holds it
+		Cell GetCell(int x, int y)const;
+
+		// Decodes the whole map
+		bool Read(WorldGrid& grid)const;
+
+		// Copies the palette indices of a palette encoded map. Uses the named cell set when cellSet is null
+		bool Read(PaletteGrid& grid, const CellSet* cellSet = nullptr)const;
+
+		// Decodes the rows x [row, row + rows) and columns [column, column + columns), touching only the chunks they cover
+		bool ReadWindow(WorldGrid& grid, int row, int column, int rows, int columns)const;
+
+	private:
+		const MapFileChunk& GetChunkEntry(int chunkRow, int chunkColumn)const;
+		Cell DecodeCell(const unsigned char* stored)const;
+
+		const unsigned char* m_Data;
+		size_t m_Size;
+		const MapFileHeader* m_Header;
+		const MapFileChunk* m_Chunks;
+#ifdef _WIN32
+		void* m_FileHandle;
+		void* m_MappingHandle;
+#endif
+	};
+}
@@ -0,0 +1,103 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "WorldGrid.h"
+
+namespace WorldGenerator
+{
+	// Grid that stores one byte per cell as an index into its CellSet's palette.
+	// Cells are decoded on read, so every stored cell shares the set's Depth and Passable data.
+	class PaletteGrid : public FlatGrid<unsigned char>
+	{
+	public:
+		static const unsigned char EMPTY_INDEX = (unsigned char)CellType::Empty;
+
+		PaletteGrid()
+		{
+			m_CellSet = nullptr;
+		}
+
+		PaletteGrid(const CellSet* cellSet)
+		{
+			m_CellSet = cellSet;
+		}
+
+		PaletteGrid(const CellSet* cellSet, int rows, int columns)
+		{
+			m_CellSet = cellSet;
+			assign(rows, columns);
+		}
+
+		void SetCellSet(const CellSet* cellSet)
+		{
+			m_CellSet = cellSet;
+		}
+
+		const CellSet* GetCellSet()const
+		{
+			return m_CellSet;
+		}
+
+		// New cells are left empty rather than index 0, which is Ground
+		void resize(int rows, int columns, unsigned char value = EMPTY_INDEX)
+		{
+			FlatGrid<unsigned char>::resize(rows, columns, value);
+		}
+
+		void assign(int rows, int columns, unsigned char value = EMPTY_INDEX)
+		{
+			FlatGrid<unsigned char>::assign(rows, columns, value);
+		}
+
+		CellType GetType(int x, int y)const
+		{
+			return (CellType)(*this)[x][y];
+		}
+
+		void SetType(int x, int y, CellType type)
+		{
+			(*this)[x][y] = CellSet::GetPaletteIndex(type);
+		}
+
+		// Decodes a single cell through the palette
+		Cell GetCell(int x, int y)const
+		{
+			if (!m_CellSet)
+				return Cell();
+
+			return m_CellSet->GetPalette()[(*this)[x][y]];
+		}
+
+		// Decodes count cells of row x, starting at column y, into a caller buffer
+		void DecodeRow(int x, int y, unsigned int count, Cell* out)const
+		{
+			const unsigned char* indices = (*this)[x].data() + y;
+			if (!m_CellSet)
+			{
+				std::fill_n(out, count, Cell());
+				return;
+			}
+
+			const Cell* palette = m_CellSet->GetPalette();
+			for (unsigned int index = 0; index < count; index++)
+			{
+				out[index] = palette[indices[index]];
+			}
+		}
+
+		// Decodes the whole grid into a full WorldGrid
+		void Decode(WorldGrid& grid)const
+		{
+			grid.reshape(RowCount(), ColumnCount());
+			for (unsigned int x = 0; x < RowCount(); x++)
+			{
+				DecodeRow(x, 0, ColumnCount(), grid[x].data());
+			}
+
+			grid.RebuildLayers();
+		}
+
+	private:
+		const CellSet* m_CellSet;
+	};
+}
@@ -0,0 +1,372 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "Pathfinder.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace WorldGenerator
+{
+	// Queries run per pool task in FindPaths
+	static const unsigned int PATH_BLOCK = 16;
+
+	static const int DIRECTIONS[8][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }, { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } };
+
+	// Cost of the cheapest path on an open map: diagonal steps for the shorter side and
+	// straight steps for the rest. Never more than the real cost, so searches stay shortest
+	static unsigned int EstimateCost(int x, int y, int goalX, int goalY)
+	{
+		const unsigned int rows = (unsigned int)std::abs(x - goalX);
+		const unsigned int columns = (unsigned int)std::abs(y - goalY);
+		const unsigned int diagonal = std::min(rows, columns);
+		return PATH_STRAIGHT_COST * (std::max(rows, columns) - diagonal) + PATH_DIAGONAL_COST * diagonal;
+	}
+
+	static int Sign(int value)
+	{
+		return (value > 0) - (value < 0);
+	}
+
+	// Follows line of lines from position, a step of direction at a time, and returns where it
+	// reaches target or where a side opens up that was walled off one step back, since the
+	// best way around that wall turns there. Returns -1 when a wall comes first.
+	// Tests 64 cells per word: a wall is a clear bit of the line, and a side opening is a set
+	// bit of a neighbouring line whose bit one step back is clear
+	static int ScanLine(const BitGrid& lines, int line, int position, int direction, int target)
+	{
+		const int wordBits = (int)BitGrid::WORD_BITS;
+		const int wordCount = (int)lines.WordsPerRow();
+		const unsigned long long* current = lines.RowWords(line);
+		const unsigned long long* sides[2] = { (line > 0) ? lines.RowWords(line - 1) : nullptr, (line + 1 < (int)lines.RowCount()) ? lines.RowWords(line + 1) : nullptr };
+		auto sideWord = [&](const unsigned long long* side, int word)
+		{
+			return (side && word >= 0 && word < wordCount) ? side[word] : 0ULL;
+		};
+
+		const int first = position + direction;
+		if (first < 0)
+			return -1;
+
+		for (int word = first / wordBits; word >= 0 && word < wordCount; word += direction)
+		{
+			unsigned long long events = ~current[word];
+			for (const unsigned long long* side : sides)
+			{
+				const unsigned long long bits = sideWord(side, word);
+				const unsigned long long behind = (direction > 0) ? (bits << 1) | (sideWord(side, word - 1) >> (wordBits - 1)) : (bits >> 1) | (sideWord(side, word + 1) << (wordBits - 1));
+				events |= bits & ~behind;
+			}
+
+			if (target >= 0 && target / wordBits == word)
+				events |= 1ULL << (target % wordBits);
+
+			if (word == first / wordBits)
+				events &= (direction > 0) ? ~0ULL << (first % wordBits) : ~0ULL >> (wordBits - 1 - first % wordBits);
+
+			if (events)
+			{
+				const int found = word * wordBits + (int)((direction > 0) ? BitGrid::CountTrailingZeros(events) : BitGrid::HighestBit(events));
+				return ((current[word] >> (found % wordBits)) & 1) ? found : -1;
+			}
+		}
+
+		return -1;
+	}
+
+	PathScratch::PathScratch()
+	{
+		m_Search = 0;
+	}
+
+	Pathfinder::Pathfinder()
+	{
+		m_Passable = nullptr;
+		m_Regions = nullptr;
+		m_Algorithm = PathAlgorithm::JumpPoint;
+	}
+
+	Pathfinder::Pathfinder(const WorldGrid& grid)
+	{
+		m_Passable = nullptr;
+		m_Regions = nullptr;
+		m_Algorithm = PathAlgorithm::JumpPoint;
+		SetGrid(grid);
+	}
+
+	void Pathfinder::SetGrid(const WorldGrid& grid)
+	{
+		SetGrid(grid.GetPassableLayer());
+	}
+
+	void Pathfinder::SetGrid(const BitGrid& passable)
+	{
+		m_Passable = &passable;
+		m_PassableColumns.assign(passable.ColumnCount(), passable.RowCount());
+		for (int x = 0; x < (int)passable.RowCount(); x++)
+		{
+			const unsigned long long* words = passable.RowWords(x);
+			for (unsigned int word = 0; word < passable.WordsPerRow(); word++)
+			{
+				for (unsigned long long bits = words[word]; bits; bits &= bits - 1)
+				{
+					m_PassableColumns.Set(word * BitGrid::WORD_BITS + BitGrid::CountTrailingZeros(bits), x, true);
+				}
+			}
+		}
+	}
+
+	void Pathfinder::SetRegions(const RegionMap* regions)
+	{
+		m_Regions = regions;
+	}
+
+	void Pathfinder::SetAlgorithm(PathAlgorithm algorithm)
+	{
+		m_Algorithm = algorithm;
+	}
+
+	bool Pathfinder::FindPath(std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>>& path, unsigned int* cost)
+	{
+		return FindPath(m_Scratch, start, goal, path, cost);
+	}
+
+	bool Pathfinder::FindPath(PathScratch& scratch, std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>>& path, unsigned int* cost) const
+	{
+		path.clear();
+		return AppendPath(scratch, start, goal, path, cost);
+	}
+
+	bool Pathfinder::AppendPath(PathScratch& scratch, std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>>& path, unsigned int* cost) const
+	{
+		if (!m_Passable || !IsOpen(start.first, start.second) || !IsOpen(goal.first, goal.second))
+			return false;
+
+		const int rows = (int)m_Passable->RowCount();
+		const int columns = (int)m_Passable->ColumnCount();
+		if (m_Regions && m_Regions->RowCount() == (unsigned int)rows && m_Regions->ColumnCount() == (unsigned int)columns &&
+			m_Regions->GetRegion(start.first, start.second) != m_Regions->GetRegion(goal.first, goal.second))
+			return false;
+
+		// Stamps tell this search's nodes from older ones, so nodes are only cleared when the
+		// grid changes size or the stamps run out
+		std::vector<PathScratch::PathNode>& nodes = scratch.m_Nodes;
+		std::vector<PathScratch::OpenEntry>& open = scratch.m_Open;
+		scratch.m_Search += 2;
+		if (nodes.size() != (size_t)rows * columns || scratch.m_Search == 0)
+		{
+			nodes.assign((size_t)rows * columns, PathScratch::PathNode{ 0, 0, 0 });
+			scratch.m_Search = 2;
+		}
+
+		const unsigned int search = scratch.m_Search;
+		const unsigned int startCell = (unsigned int)(start.first * columns + start.second);
+		const unsigned int goalCell = (unsigned int)(goal.first * columns + goal.second);
+		open.clear();
+
+		// The heap keeps the lowest estimate on top, breaking ties toward the entry furthest along
+		auto isLowerPriority = [](const PathScratch::OpenEntry& left, const PathScratch::OpenEntry& right)
+		{
+			return left.Estimate > right.Estimate || (left.Estimate == right.Estimate && left.Cost < right.Cost);
+		};
+
+		auto reach = [&](unsigned int cell, unsigned int parent, unsigned int pathCost)
+		{
+			PathScratch::PathNode& node = nodes[cell];
+			if (node.Search == (search | 1) || (node.Search == search && node.Cost <= pathCost))
+				return;
+
+			node.Search = search;
+			node.Cost = pathCost;
+			node.Parent = parent;
+			open.push_back({ pathCost + EstimateCost(cell / columns, cell % columns, goal.first, goal.second), pathCost, cell });
+			std::push_heap(open.begin(), open.end(), isLowerPriority);
+		};
+
+		reach(startCell, startCell, 0);
+		while (!open.empty())
+		{
+			std::pop_heap(open.begin(), open.end(), isLowerPriority);
+			const PathScratch::OpenEntry entry = open.back();
+			open.pop_back();
+
+			PathScratch::PathNode& node = nodes[entry.Cell];
+			if (node.Search != search || node.Cost != entry.Cost)
+				continue;
+
+			node.Search = search | 1;
+			if (entry.Cell == goalCell)
+				break;
+
+			const int x = entry.Cell / columns;
+			const int y = entry.Cell % columns;
+			if (m_Algorithm == PathAlgorithm::AStar)
+			{
+				for (const int* direction : DIRECTIONS)
+				{
+					if (CanStep(x, y, direction[0], direction[1]))
+						reach((x + direction[0]) * columns + y + direction[1], entry.Cell, node.Cost + ((direction[0] && direction[1]) ? PATH_DIAGONAL_COST : PATH_STRAIGHT_COST));
+				}
+
+				continue;
+			}
+
+			// Only directions a shorter path could not have taken without passing through this
+			// cell are worth following: straight on, and the turns walls may have forced
+			int candidates[5][2];
+			int candidateCount = 0;
+			const int dx = Sign(x - (int)(node.Parent / columns));
+			const int dy = Sign(y - (int)(node.Parent % columns));
+			if (dx && dy)
+			{
+				const int diagonal[3][2] = { { dx, 0 }, { 0, dy }, { dx, dy } };
+				std::copy(&diagonal[0][0], &diagonal[0][0] + 6, &candidates[0][0]);
+				candidateCount = 3;
+			}
+			else if (dx || dy)
+			{
+				// Side steps and the diagonals leaning toward them
+				const int straight[5][2] = { { dx, dy }, { dx + dy, dy + dx }, { dx - dy, dy - dx }, { dy, dx }, { -dy, -dx } };
+				std::copy(&straight[0][0], &straight[0][0] + 10, &candidates[0][0]);
+				candidateCount = 5;
+			}
+
+			const int (*directions)[2] = candidateCount ? candidates : DIRECTIONS;
+			for (int index = 0, count = candidateCount ? candidateCount : 8; index < count; index++)
+			{
+				int jumpPoint;
+				if (CanStep(x, y, directions[index][0], directions[index][1]) && Jump(x, y, directions[index][0], directions[index][1], (int)goalCell, jumpPoint))
+					reach((unsigned int)jumpPoint, entry.Cell, node.Cost + EstimateCost(x, y, jumpPoint / columns, jumpPoint % columns));
+			}
+		}
+
+		if (nodes[goalCell].Search != (search | 1))
+			return false;
+
+		// Walk back from the goal. Jump points are joined by straight or diagonal lines, so
+		// each line is filled in by stepping toward the parent
+		const size_t firstCell = path.size();
+		for (unsigned int cell = goalCell; cell != startCell; cell = nodes[cell].Parent)
+		{
+			const int parentX = nodes[cell].Parent / columns;
+			const int parentY = nodes[cell].Parent % columns;
+			int x = cell / columns;
+			int y = cell % columns;
+			const int dx = Sign(parentX - x);
+			const int dy = Sign(parentY - y);
+			for (; x != parentX || y != parentY; x += dx, y += dy)
+			{
+				path.push_back(std::make_pair(x, y));
+			}
+		}
+
+		path.push_back(start);
+		std::reverse(path.begin() + firstCell, path.end());
+		if (cost)
+			*cost = nodes[goalCell].Cost;
+
+		return true;
+	}
+
+	void Pathfinder::FindPaths(const std::vector<PathQuery>& queries, PathBatch& batch, ThreadPool* pool)
+	{
+		const unsigned int threadCount = ThreadPool::GetThreadCount(pool);
+		while (m_WorkerScratch.size() < threadCount)
+		{
+			m_WorkerScratch.emplace_back(new PathScratch());
+		}
+
+		if (m_WorkerCells.size() < threadCount)
+			m_WorkerCells.resize(threadCount);
+
+		for (std::vector<std::pair<int, int>>& cells : m_WorkerCells)
+		{
+			cells.clear();
+		}
+
+		// Each worker appends its paths to its own cells, then they are gathered in query order
+		const unsigned int queryCount = (unsigned int)queries.size();
+		batch.Results.resize(queryCount);
+		m_QueryWorkers.resize(queryCount);
+		ThreadPool::ParallelFor(pool, (queryCount + PATH_BLOCK - 1) / PATH_BLOCK, [&](unsigned int block, unsigned int worker)
+		{
+			PathScratch& scratch = *m_WorkerScratch[worker];
+			std::vector<std::pair<int, int>>& cells = m_WorkerCells[worker];
+			const unsigned int last = std::min(queryCount, (block + 1) * PATH_BLOCK);
+			for (unsigned int query = block * PATH_BLOCK; query < last; query++)
+			{
+				PathResult& result = batch.Results[query];
+				result.FirstCell = (unsigned int)cells.size();
+				result.Cost = 0;
+				result.bFound = AppendPath(scratch, queries[query].Start, queries[query].Goal, cells, &result.Cost);
+				result.CellCount = (unsigned int)cells.size() - result.FirstCell;
+				m_QueryWorkers[query] = worker;
+			}
+		});
+
+		batch.Cells.clear();
+		for (unsigned int query = 0; query < queryCount; query++)
+		{
+			PathResult& result = batch.Results[query];
+			const std::vector<std::pair<int, int>>& cells = m_WorkerCells[m_QueryWorkers[query]];
+			const unsigned int firstCell = (unsigned int)batch.Cells.size();
+			batch.Cells.insert(batch.Cells.end(), cells.begin() + result.FirstCell, cells.begin() + result.FirstCell + result.CellCount);
+			result.FirstCell = firstCell;
+		}
+	}
+
+	PathAlgorithm Pathfinder::GetAlgorithm() const
+	{
+		return m_Algorithm;
+	}
+
+	bool Pathfinder::IsOpen(int x, int y) const
+	{
+		return x >= 0 && y >= 0 && (unsigned int)x < m_Passable->RowCount() && (unsigned int)y < m_Passable->ColumnCount() && m_Passable->Get(x, y);
+	}
+
+	bool Pathfinder::CanStep(int x, int y, int dx, int dy) const
+	{
+		if (dx && dy && !(IsOpen(x + dx, y) && IsOpen(x, y + dy)))
+			return false;
+
+		return IsOpen(x + dx, y + dy);
+	}
+
+	bool Pathfinder::Jump(int x, int y, int dx, int dy, int goal, int& jumpPoint) const
+	{
+		if (!dx || !dy)
+			return JumpStraight(x, y, dx, dy, goal, jumpPoint);
+
+		// A diagonal stops wherever one of its straight sides finds something
+		const int columns = (int)m_Passable->ColumnCount();
+		for (;;)
+		{
+			x += dx;
+			y += dy;
+			jumpPoint = x * columns + y;
+			if (jumpPoint == goal)
+				return true;
+
+			int sideJump;
+			if ((CanStep(x, y, dx, 0) && JumpStraight(x, y, dx, 0, goal, sideJump)) || (CanStep(x, y, 0, dy) && JumpStraight(x, y, 0, dy, goal, sideJump)))
+				return true;
+
+			if (!CanStep(x, y, dx, dy))
+				return false;
+		}
+	}
+
+	bool Pathfinder::JumpStraight(int x, int y, int dx, int dy, int goal, int& jumpPoint) const
+	{
+		const int columns = (int)m_Passable->ColumnCount();
+		if (!dx)
+		{
+			const int column = ScanLine(*m_Passable, x, y, dy, (goal / columns == x) ? goal % columns : -1);
+			jumpPoint = x * columns + column;
+			return column >= 0;
+		}
+
+		const int row = ScanLine(m_PassableColumns, y, x, dx, (goal % columns == y) ? goal / columns : -1);
+		jumpPoint = row * columns + y;
+		return row >= 0;
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "RegionMap.h"
+#include <memory>
+
+namespace WorldGenerator
+{
+	// Cost of a step along a row or column, and of a diagonal step
+	static const unsigned int PATH_STRAIGHT_COST = 10;
+	static const unsigned int PATH_DIAGONAL_COST = 14;
+
+	enum class PathAlgorithm : unsigned char
+	{
+		// Expands every neighbour of every cell it visits
+		AStar,
+		// Jump point search. Skips over runs of open cells that cannot branch, so it visits far
+		// fewer cells on open maps and finds paths of the same cost
+		JumpPoint,
+	};
+
+	struct PathQuery
+	{
+		std::pair<int, int> Start;
+		std::pair<int, int> Goal;
+	};
+
+	// Path of one query, stored in PathBatch::Cells
+	struct PathResult
+	{
+		bool bFound;
+		unsigned int Cost;
+		unsigned int FirstCell;
+		unsigned int CellCount;
+	};
+
+	// Paths found by Pathfinder::FindPaths. Keeping a batch between calls reuses its storage
+	struct PathBatch
+	{
+		// Every path, one after another, each from start to goal inclusive
+		std::vector<std::pair<int, int>> Cells;
+		// One per query, in query order
+		std::vector<PathResult> Results;
+	};
+
+	// Search state for one thread. Sized to the grid on first use and kept between searches,
+	// so a search only allocates when the grid grows or the open list outgrows every earlier one
+	class PathScratch
+	{
+	public:
+		PathScratch();
+
+	private:
+		friend class Pathfinder;
+
+		struct PathNode
+		{
+			// Stamp of the last search that reached the node. Odd once the node is closed
+			unsigned int Search;
+			unsigned int Cost;
+			unsigned int Parent;
+		};
+
+		struct OpenEntry
+		{
+			unsigned int Estimate;
+			unsigned int Cost;
+			unsigned int Cell;
+		};
+
+		std::vector<PathNode> m_Nodes;
+		// Binary heap. Entries are never removed early: an entry for a node that has since
+		// been closed is skipped when it comes up
+		std::vector<OpenEntry> m_Open;
+		unsigned int m_Search;
+	};
+
+	// Finds shortest paths over a grid's passable cells. Moves go to all eight neighbours,
+	// but a diagonal move needs both cells beside it open, so paths never cut corners
+	class Pathfinder
+	{
+	public:
+		Pathfinder();
+		explicit Pathfinder(const WorldGrid& grid);
+
+		// Searches the grid's passable layer, which has to stay alive and unchanged while in use.
+		// Keeps a copy of the layer turned on its side, so setting the grid costs a pass over it
+		void SetGrid(const WorldGrid& grid);
+		void SetGrid(const BitGrid& passable);
+
+		// Lets queries between regions fail without searching. The regions have to be built
+		// from the same grid, or nullptr to stop using them
+		void SetRegions(const RegionMap* regions);
+
+		void SetAlgorithm(PathAlgorithm algorithm);
+
+		// Finds a path from start to goal inclusive, and its cost in PATH_STRAIGHT_COST and
+		// PATH_DIAGONAL_COST steps. Returns false when either end is blocked or no path exists
+		bool FindPath(std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>>& path, unsigned int* cost = nullptr);
+
+		// Same as above with the caller's scratch, so any number of threads can search at once
+		bool FindPath(PathScratch& scratch, std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>>& path, unsigned int* cost = nullptr)const;
+
+		// Runs every query, spread over the pool with a scratch kept per worker. Runs on the
+		// calling thread when no pool is given
+		void FindPaths(const std::vector<PathQuery>& queries, PathBatch& batch, ThreadPool* pool = nullptr);
+
+		PathAlgorithm GetAlgorithm()const;
+
+	private:
+		// FindPath without clearing the path first, so a batch can gather paths in one array
+		bool AppendPath(PathScratch& scratch, std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>>& path, unsigned int* cost)const;
+
+		bool IsOpen(int x, int y)const;
+
+		// Whether a move from the cell by (dx, dy) lands on an open cell without cutting a corner
+		bool CanStep(int x, int y, int dx, int dy)const;
+
+		// Follows (dx, dy) from the cell until it reaches the goal or a cell where the path could
+		// branch. Returns false when it runs into a wall first
+		bool Jump(int x, int y, int dx, int dy, int goal, int& jumpPoint)const;
+		bool JumpStraight(int x, int y, int dx, int dy, int goal, int& jumpPoint)const;
+
+		const BitGrid* m_Passable;
+		// Passable layer with rows and columns swapped, so jumps along a column scan words too
+		BitGrid m_PassableColumns;
+		const RegionMap* m_Regions;
+		PathAlgorithm m_Algorithm;
+		PathScratch m_Scratch;
+
+		// Kept between FindPaths calls so batches reuse them
+		std::vector<std::unique_ptr<PathScratch>> m_WorkerScratch;
+		std::vector<std::vector<std::pair<int, int>>> m_WorkerCells;
+		std::vector<unsigned int> m_QueryWorkers;
+	};
+}
@@ -0,0 +1,243 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include <random>
+
+namespace WorldGenerator
+{
+	// SplitMix64 finalizer. Spreads nearby inputs (seeds, ids, coordinates) over the whole 64 bit range
+	inline unsigned long long MixSeed(unsigned long long value)
+	{
+		value += 0x9E3779B97F4A7C15ull;
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+
+	// Derives an independent seed for stream id from a base seed
+	inline unsigned long long DeriveSeed(unsigned long long seed, unsigned long long id)
+	{
+		return MixSeed(MixSeed(seed) ^ id);
+	}
+
+	// Engines a generator can draw from. Every engine gives each (seed, stream) pair its own sequence
+	enum class RandomEngineType : unsigned char
+	{
+		// xoshiro256++. Fast general purpose engine, the default
+		Xoshiro256 = 0,
+		// PCG32. Smallest state, with streams picked by the increment
+		PCG32,
+		// Hash of a counter. Any position of any stream is reachable in O(1)
+		Counter,
+		// std::mt19937, seeded from the derived stream seed
+		MT19937,
+	};
+
+	// xoshiro256++ by Blackman and Vigna. 32 bytes of state, seeded from (seed, stream) through SplitMix64
+	class Xoshiro256
+	{
+	public:
+		typedef unsigned long long result_type;
+
+		Xoshiro256(unsigned long long seed = 0, unsigned long long stream = 0)
+		{
+			unsigned long long key = DeriveSeed(seed, stream);
+			for (int index = 0; index < 4; index++)
+			{
+				m_State[index] = MixSeed(key + index * 0x9E3779B97F4A7C15ull);
+			}
+		}
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return ~0ull; }
+
+		result_type operator()()
+		{
+			const unsigned long long result = RotateLeft(m_State[0] + m_State[3], 23) + m_State[0];
+			const unsigned long long shifted = m_State[1] << 17;
+
+			m_State[2] ^= m_State[0];
+			m_State[3] ^= m_State[1];
+			m_State[1] ^= m_State[2];
+			m_State[0] ^= m_State[3];
+			m_State[2] ^= shifted;
+			m_State[3] = RotateLeft(m_State[3], 45);
+
+			return result;
+		}
+
+	private:
+		static unsigned long long RotateLeft(unsigned long long value, int count)
+		{
+			return (value << count) | (value >> (64 - count));
+		}
+
+		unsigned long long m_State[4];
+	};
+
+	// PCG32 (XSH RR) by O'Neill. The stream selects the increment, so streams never share a sequence
+	class Pcg32
+	{
+	public:
+		typedef unsigned int result_type;
+
+		Pcg32(unsigned long long seed = 0, unsigned long long stream = 0)
+		{
+			// Mixing the stream keeps neighbouring ids from giving correlated increments
+			m_Increment = (MixSeed(stream) << 1) | 1;
+			m_State = 0;
+			(*this)();
+			m_State += MixSeed(seed);
+			(*this)();
+		}
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+		result_type operator()()
+		{
+			unsigned long long state = m_State;
+			m_State = state * 6364136223846793005ull + m_Increment;
+			unsigned int xorShifted = (unsigned int)(((state >> 18) ^ state) >> 27);
+			unsigned int rotation = (unsigned int)(state >> 59);
+			return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+		}
+
+	private:
+		unsigned long long m_State;
+		unsigned long long m_Increment;
+	};
+
+	// Counter based engine. Output n of a stream is MixSeed of the stream key and n, so the only
+	// state is the counter and skipping ahead or starting a new stream costs nothing
+	class CounterEngine
+	{
+	public:
+		typedef unsigned long long result_type;
+
+		CounterEngine(unsigned long long seed = 0, unsigned long long stream = 0)
+		{
+			m_Key = DeriveSeed(seed, stream);
+			m_Counter = 0;
+		}
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return ~0ull; }
+
+		result_type operator()()
+		{
+			return MixSeed(m_Key + (m_Counter++) * 0x9E3779B97F4A7C15ull);
+		}
+
+		// Skips count outputs
+		void discard(unsigned long long count)
+		{
+			m_Counter += count;
+		}
+
+		unsigned long long GetCounter()const
+		{
+			return m_Counter;
+		}
+
+	private:
+		unsigned long long m_Key;
+		unsigned long long m_Counter;
+	};
+
+	// Builds the engine for stream id of seed. Engines of the same type built from different
+	// streams are independent, which is what walkers, chunks and landmarks rely on
+	template<typename Engine>
+	inline Engine MakeEngine(unsigned long long seed, unsigned long long stream)
+	{
+		return Engine(seed, stream);
+	}
+
+	template<>
+	inline std::mt19937 MakeEngine<std::mt19937>(unsigned long long seed, unsigned long long stream)
+	{
+		return std::mt19937((std::mt19937::result_type)DeriveSeed(seed, stream));
+	}
+
+	// 32 random bits from a 32 or 64 bit engine. 64 bit engines give their high half, which is the stronger one
+	template<typename Engine>
+	inline unsigned int NextBits(Engine& rng)
+	{
+		static_assert(Engine::min() == 0 && (Engine::max() == 0xFFFFFFFFull || Engine::max() == ~0ull), "Engine must produce full 32 or 64 bit words");
+		return (Engine::max() > 0xFFFFFFFFull) ? (unsigned int)((unsigned long long)rng() >> 32) : (unsigned int)rng();
+	}
+
+	// Uniform integer in [0, bound) by Lemire's multiply and shift. Only rejects when the low
+	// half lands in the biased sliver, so the division is almost never reached
+	template<typename Engine>
+	inline unsigned int UniformInt(Engine& rng, unsigned int bound)
+	{
+		unsigned long long product = (unsigned long long)NextBits(rng) * bound;
+		unsigned int low = (unsigned int)product;
+		if (low < bound)
+		{
+			unsigned int threshold = (0u - bound) % bound;
+			while (low < threshold)
+			{
+				product = (unsigned long long)NextBits(rng) * bound;
+				low = (unsigned int)product;
+			}
+		}
+
+		return (unsigned int)(product >> 32);
+	}
+
+	// Uniform integer in [first, last], both ends inclusive
+	template<typename Engine>
+	inline int UniformRange(Engine& rng, int first, int last)
+	{
+		if (last <= first)
+			return first;
+
+		unsigned int span = (unsigned int)last - (unsigned int)first;
+		if (span == 0xFFFFFFFFu)
+			return (int)NextBits(rng);
+
+		return (int)((unsigned int)first + UniformInt(rng, span + 1));
+	}
+
+	template<typename Engine>
+	inline bool UniformBool(Engine& rng)
+	{
+		return (NextBits(rng) >> 31) != 0;
+	}
+
+	// Calls function with an engine of the given type for stream id of seed. Lets code that is
+	// templated on the engine be chosen at runtime, e.g. from a generator setting
+	template<typename Function>
+	inline void WithRandomEngine(RandomEngineType type, unsigned long long seed, unsigned long long stream, Function&& function)
+	{
+		switch (type)
+		{
+		case RandomEngineType::PCG32:
+		{
+			Pcg32 rng = MakeEngine<Pcg32>(seed, stream);
+			function(rng);
+			break;
+		}
+		case RandomEngineType::Counter:
+		{
+			CounterEngine rng = MakeEngine<CounterEngine>(seed, stream);
+			function(rng);
+			break;
+		}
+		case RandomEngineType::MT19937:
+		{
+			std::mt19937 rng = MakeEngine<std::mt19937>(seed, stream);
+			function(rng);
+			break;
+		}
+		default:
+		{
+			Xoshiro256 rng = MakeEngine<Xoshiro256>(seed, stream);
+			function(rng);
+			break;
+		}
+		}
+	}
+}
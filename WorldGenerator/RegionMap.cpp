@@ -0,0 +1,299 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "RegionMap.h"
+
+namespace WorldGenerator
+{
+	// Rows labelled per pool task
+	static const int REGION_BAND = 64;
+
+	// Passable cells [First, Last) of one row
+	struct CellRun
+	{
+		int Row;
+		int First;
+		int Last;
+	};
+
+	// Runs of a band of rows, with the union-find joining them. RowStarts holds the first run
+	// of each row and one past the last run of the band
+	struct RegionBand
+	{
+		std::vector<CellRun> Runs;
+		std::vector<unsigned int> Parents;
+		std::vector<unsigned int> RowStarts;
+	};
+
+	// Root of a run's set, halving the path on the way
+	static unsigned int FindRoot(unsigned int* parents, unsigned int run)
+	{
+		while (parents[run] != run)
+		{
+			parents[run] = parents[parents[run]];
+			run = parents[run];
+		}
+
+		return run;
+	}
+
+	// Joins two sets under the lower root, so a root is always the first run of its set
+	static void JoinRuns(unsigned int* parents, unsigned int first, unsigned int second)
+	{
+		first = FindRoot(parents, first);
+		second = FindRoot(parents, second);
+		if (first < second)
+			parents[second] = first;
+		else if (second < first)
+			parents[first] = second;
+	}
+
+	// Joins each run of a row with the runs of the row above sharing a column with it.
+	// Both rows are sorted by column, so one sweep finds every pair
+	static void JoinTouchingRuns(unsigned int* parents, const CellRun* runs, unsigned int upperFirst, unsigned int upperLast, unsigned int lowerFirst, unsigned int lowerLast)
+	{
+		unsigned int upper = upperFirst;
+		unsigned int lower = lowerFirst;
+		while (upper < upperLast && lower < lowerLast)
+		{
+			if (runs[upper].First < runs[lower].Last && runs[lower].First < runs[upper].Last)
+				JoinRuns(parents, upper, lower);
+
+			if (runs[upper].Last < runs[lower].Last)
+				upper++;
+			else
+				lower++;
+		}
+	}
+
+	// Appends the runs of set bits in row x
+	static void FindRuns(const BitGrid& passable, int x, std::vector<CellRun>& runs)
+	{
+		const unsigned long long* words = passable.RowWords(x);
+		const int wordBits = (int)BitGrid::WORD_BITS;
+		int runStart = -1;
+		for (int word = 0; word < (int)passable.WordsPerRow(); word++)
+		{
+			const unsigned long long bits = words[word];
+			int offset = 0;
+			while (offset < wordBits)
+			{
+				if (runStart < 0)
+				{
+					unsigned long long rest = bits >> offset;
+					if (!rest)
+						break;
+
+					offset += BitGrid::CountTrailingZeros(rest);
+					runStart = word * wordBits + offset;
+				}
+
+				// Bits shifted in from the top read as passable, so a run reaching the end of
+				// the word carries on into the next one
+				unsigned long long gaps = ~bits >> offset;
+				if (!gaps)
+					break;
+
+				offset += BitGrid::CountTrailingZeros(gaps);
+				runs.push_back({ x, runStart, word * wordBits + offset });
+				runStart = -1;
+			}
+		}
+
+		if (runStart >= 0)
+			runs.push_back({ x, runStart, (int)passable.ColumnCount() });
+	}
+
+	const unsigned int RegionMap::NO_REGION;
+
+	RegionMap::RegionMap()
+	{
+	}
+
+	void RegionMap::Build(const WorldGrid& grid, ThreadPool* pool)
+	{
+		Build(grid.GetPassableLayer(), pool);
+	}
+
+	void RegionMap::Build(const BitGrid& passable, ThreadPool* pool)
+	{
+		const int rows = (int)passable.RowCount();
+		const int columns = (int)passable.ColumnCount();
+		const unsigned int bandCount = (rows + REGION_BAND - 1) / REGION_BAND;
+
+		// Find the runs of each band and join them within the band
+		std::vector<RegionBand> bands(bandCount);
+		ThreadPool::ParallelFor(pool, bandCount, [&](unsigned int index, unsigned int)
+		{
+			RegionBand& band = bands[index];
+			const int firstRow = index * REGION_BAND;
+			const int lastRow = std::min(firstRow + REGION_BAND, rows);
+			for (int x = firstRow; x < lastRow; x++)
+			{
+				band.RowStarts.push_back((unsigned int)band.Runs.size());
+				FindRuns(passable, x, band.Runs);
+			}
+
+			band.RowStarts.push_back((unsigned int)band.Runs.size());
+			band.Parents.resize(band.Runs.size());
+			for (unsigned int run = 0; run < (unsigned int)band.Runs.size(); run++)
+			{
+				band.Parents[run] = run;
+			}
+
+			for (int row = 1; row < lastRow - firstRow; row++)
+			{
+				JoinTouchingRuns(band.Parents.data(), band.Runs.data(), band.RowStarts[row - 1], band.RowStarts[row], band.RowStarts[row], band.RowStarts[row + 1]);
+			}
+		});
+
+		// Lay the bands end to end, so every run has one index and the sets can be joined across bands
+		std::vector<unsigned int> firstRuns(bandCount + 1, 0);
+		for (unsigned int index = 0; index < bandCount; index++)
+		{
+			firstRuns[index + 1] = firstRuns[index] + (unsigned int)bands[index].Runs.size();
+		}
+
+		const unsigned int runCount = firstRuns[bandCount];
+		std::vector<CellRun> runs(runCount);
+		std::vector<unsigned int> parents(runCount);
+		ThreadPool::ParallelFor(pool, bandCount, [&](unsigned int index, unsigned int)
+		{
+			const RegionBand& band = bands[index];
+			const unsigned int firstRun = firstRuns[index];
+			std::copy(band.Runs.begin(), band.Runs.end(), runs.begin() + firstRun);
+			for (unsigned int run = 0; run < (unsigned int)band.Parents.size(); run++)
+			{
+				parents[firstRun + run] = band.Parents[run] + firstRun;
+			}
+		});
+
+		for (unsigned int index = 1; index < bandCount; index++)
+		{
+			const RegionBand& upper = bands[index - 1];
+			const RegionBand& lower = bands[index];
+			JoinTouchingRuns(parents.data(), runs.data(), firstRuns[index - 1] + upper.RowStarts[upper.RowStarts.size() - 2], firstRuns[index], firstRuns[index], firstRuns[index] + lower.RowStarts[1]);
+		}
+
+		// A root is the first run of its set, so it is numbered before any run joined to it
+		m_Regions.clear();
+		std::vector<unsigned int> runRegions(runCount);
+		for (unsigned int run = 0; run < runCount; run++)
+		{
+			const CellRun& cells = runs[run];
+			const unsigned int root = FindRoot(parents.data(), run);
+			if (root == run)
+			{
+				runRegions[run] = (unsigned int)m_Regions.size();
+				m_Regions.push_back({ 0, std::make_pair(cells.Row, cells.Row), std::make_pair(cells.First, cells.Last - 1) });
+			}
+			else
+			{
+				runRegions[run] = runRegions[root];
+			}
+
+			RegionInfo& region = m_Regions[runRegions[run]];
+			region.CellCount += cells.Last - cells.First;
+			region.RowRange.second = cells.Row;
+			region.ColumnRange.first = std::min(region.ColumnRange.first, cells.First);
+			region.ColumnRange.second = std::max(region.ColumnRange.second, cells.Last - 1);
+		}
+
+		m_Labels.reshape(rows, columns);
+		ThreadPool::ParallelFor(pool, bandCount, [&](unsigned int index, unsigned int)
+		{
+			const RegionBand& band = bands[index];
+			const int firstRow = index * REGION_BAND;
+			for (unsigned int row = 0; row + 1 < (unsigned int)band.RowStarts.size(); row++)
+			{
+				unsigned int* labels = m_Labels[firstRow + row].data();
+				std::fill_n(labels, columns, NO_REGION);
+				for (unsigned int run = band.RowStarts[row]; run < band.RowStarts[row + 1]; run++)
+				{
+					const CellRun& cells = band.Runs[run];
+					std::fill(labels + cells.First, labels + cells.Last, runRegions[firstRuns[index] + run]);
+				}
+			}
+		});
+	}
+
+	void RegionMap::clear()
+	{
+		m_Labels.clear();
+		m_Regions.clear();
+	}
+
+	unsigned int RegionMap::RowCount() const
+	{
+		return m_Labels.RowCount();
+	}
+
+	unsigned int RegionMap::ColumnCount() const
+	{
+		return m_Labels.ColumnCount();
+	}
+
+	unsigned int RegionMap::GetRegion(int x, int y) const
+	{
+		if (x < 0 || (unsigned int)x >= m_Labels.RowCount() || y < 0 || (unsigned int)y >= m_Labels.ColumnCount())
+			return NO_REGION;
+
+		return m_Labels[x][y];
+	}
+
+	unsigned int RegionMap::GetRegionCount() const
+	{
+		return (unsigned int)m_Regions.size();
+	}
+
+	const RegionInfo& RegionMap::GetRegionInfo(unsigned int region) const
+	{
+		return m_Regions[region];
+	}
+
+	const std::vector<RegionInfo>& RegionMap::GetRegions() const
+	{
+		return m_Regions;
+	}
+
+	unsigned int RegionMap::GetLargestRegion() const
+	{
+		unsigned int largest = NO_REGION;
+		for (unsigned int region = 0; region < (unsigned int)m_Regions.size(); region++)
+		{
+			if (largest == NO_REGION || m_Regions[region].CellCount > m_Regions[largest].CellCount)
+				largest = region;
+		}
+
+		return largest;
+	}
+
+	const FlatGrid<unsigned int>& RegionMap::GetLabels() const
+	{
+		return m_Labels;
+	}
+
+	bool RegionMap::IsConnectedFrom(int x, int y) const
+	{
+		return GetRegion(x, y) != NO_REGION && m_Regions.size() == 1;
+	}
+
+	bool RegionMap::AreConnected(std::pair<int, int> start, const std::vector<std::pair<int, int>>& cells) const
+	{
+		const unsigned int region = GetRegion(start.first, start.second);
+		if (region == NO_REGION)
+			return false;
+
+		for (const std::pair<int, int>& cell : cells)
+		{
+			if (GetRegion(cell.first, cell.second) != region)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool RegionMap::AreConnected(const std::vector<std::pair<int, int>>& cells) const
+	{
+		return cells.empty() || AreConnected(cells.front(), cells);
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "WorldGrid.h"
+#include "ThreadPool.h"
+
+namespace WorldGenerator
+{
+	// Size and bounds of one connected region
+	struct RegionInfo
+	{
+		unsigned long long CellCount;
+		// Bounds of the region, both ends inclusive
+		std::pair<int, int> RowRange;
+		std::pair<int, int> ColumnRange;
+	};
+
+	// Labels the connected regions of passable cells. Cells are connected through their four
+	// side neighbours. Rows are split into bands labelled in parallel: each band breaks its
+	// rows into runs of passable cells and joins runs touching the run above through a
+	// union-find, then the bands are joined where they meet. Regions are numbered in the order
+	// their first cell appears, row by row, so the labels do not depend on the pool
+	class RegionMap
+	{
+	public:
+		// Label of impassable cells
+		static const unsigned int NO_REGION = ~0u;
+
+		RegionMap();
+
+		// Labels the grid's passable layer, so the layers have to be up to date. Runs on the
+		// calling thread when no pool is given
+		void Build(const WorldGrid& grid, ThreadPool* pool = nullptr);
+		void Build(const BitGrid& passable, ThreadPool* pool = nullptr);
+
+		void clear();
+
+		unsigned int RowCount()const;
+		unsigned int ColumnCount()const;
+
+		// Region of the cell, or NO_REGION when it is impassable or off the map
+		unsigned int GetRegion(int x, int y)const;
+
+		unsigned int GetRegionCount()const;
+		const RegionInfo& GetRegionInfo(unsigned int region)const;
+		const std::vector<RegionInfo>& GetRegions()const;
+
+		// Region holding the most cells, or NO_REGION when nothing is passable
+		unsigned int GetLargestRegion()const;
+
+		// Label of every cell
+		const FlatGrid<unsigned int>& GetLabels()const;
+
+		// Whether the cell is passable and every passable cell can be reached from it,
+		// e.g. the walker start of a generated map
+		bool IsConnectedFrom(int x, int y)const;
+
+		// Whether every cell can be reached from start, e.g. a landmark's exits from its center
+		bool AreConnected(std::pair<int, int> start, const std::vector<std::pair<int, int>>& cells)const;
+
+		// Whether all the cells are passable and share one region
+		bool AreConnected(const std::vector<std::pair<int, int>>& cells)const;
+
+	private:
+		FlatGrid<unsigned int> m_Labels;
+		std::vector<RegionInfo> m_Regions;
+	};
+}
@@ -0,0 +1,9 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+// SSE2 is part of every x64 target, so it is the only instruction set the SIMD paths rely on.
+// Everything that uses it keeps a scalar fallback for other targets
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WORLDGEN_SSE2 1
+#endif
@@ -0,0 +1,81 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "TaskExecutor.h"
+#include <algorithm>
+
+namespace WorldGenerator
+{
+	TaskExecutor::TaskExecutor(unsigned int threadCount)
+	{
+		m_bStopping = false;
+
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		for (unsigned int worker = 0; worker < threadCount; worker++)
+		{
+			m_Threads.emplace_back(&TaskExecutor::WorkerLoop, this);
+		}
+	}
+
+	TaskExecutor::~TaskExecutor()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_bStopping = true;
+		}
+
+		m_JobReady.notify_all();
+		for (auto& thread : m_Threads)
+		{
+			thread.join();
+		}
+	}
+
+	bool TaskExecutor::Submit(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_bStopping)
+				return false;
+
+			m_Jobs.push_back(std::move(job));
+		}
+
+		m_JobReady.notify_one();
+		return true;
+	}
+
+	unsigned int TaskExecutor::GetThreadCount() const
+	{
+		return (unsigned int)m_Threads.size();
+	}
+
+	void TaskExecutor::WorkerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_JobReady.wait(lock, [this]() { return m_bStopping || !m_Jobs.empty(); });
+
+				// Queued jobs still run after stopping, so their callers are never left waiting
+				if (m_Jobs.empty())
+					return;
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+
+			// A throwing job must not take the worker, and every job queued behind it, down with it
+			try
+			{
+				job();
+			}
+			catch (...)
+			{
+			}
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace WorldGenerator
+{
+	// Worker threads that run jobs in the background, first in first out. Unlike ThreadPool
+	// the caller never waits, so anything it needs from a job has to come back through the job
+	class TaskExecutor
+	{
+	public:
+		// Zero uses one thread per hardware core
+		TaskExecutor(unsigned int threadCount);
+
+		// Waits for every submitted job to finish, including the ones that have not started
+		~TaskExecutor();
+
+		TaskExecutor(const TaskExecutor&) = delete;
+		TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+		// Returns false without queueing the job once the executor is shutting down.
+		// Exceptions a job lets escape are discarded, so jobs report their own failures
+		bool Submit(std::function<void()> job);
+
+		unsigned int GetThreadCount()const;
+
+	private:
+		void WorkerLoop();
+
+		std::vector<std::thread> m_Threads;
+		std::deque<std::function<void()>> m_Jobs;
+		std::mutex m_Mutex;
+		std::condition_variable m_JobReady;
+		bool m_bStopping;
+	};
+}
@@ -0,0 +1,225 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace WorldGenerator
+{
+	// Pool whose task the current thread is running, used to run nested loops inline
+	static thread_local const ThreadPool* t_ActivePool = nullptr;
+
+	// Marks the current thread as running tasks of a pool until it goes out of scope
+	class ActivePoolScope
+	{
+	public:
+		ActivePoolScope(const ThreadPool* pool) :
+			m_PreviousPool(t_ActivePool)
+		{
+			t_ActivePool = pool;
+		}
+
+		~ActivePoolScope()
+		{
+			t_ActivePool = m_PreviousPool;
+		}
+
+	private:
+		const ThreadPool* m_PreviousPool;
+	};
+
+	ThreadPool::ThreadPool(unsigned int threadCount)
+	{
+		m_Task = nullptr;
+		m_BusyWorkers = 0;
+		m_bFailed = false;
+		m_Generation = 0;
+		m_bStopping = false;
+
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		for (unsigned int worker = 0; worker < threadCount; worker++)
+		{
+			m_Queues.emplace_back(new WorkQueue());
+		}
+
+		for (unsigned int worker = 1; worker < threadCount; worker++)
+		{
+			m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, worker);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_bStopping = true;
+		}
+
+		m_WorkReady.notify_all();
+		for (auto& thread : m_Threads)
+		{
+			thread.join();
+		}
+	}
+
+	void ThreadPool::ParallelFor(unsigned int count, const std::function<void(unsigned int, unsigned int)>& task)
+	{
+		if (count == 0)
+			return;
+
+		// Not worth waking anyone for a single task, and nested loops would wait on themselves
+		if (m_Threads.empty() || count == 1 || t_ActivePool == this)
+		{
+			for (unsigned int index = 0; index < count; index++)
+			{
+				task(index, 0);
+			}
+
+			return;
+		}
+
+		// Only one loop may own the workers at a time
+		std::lock_guard<std::mutex> forLock(m_ForMutex);
+
+		// Hand every worker a contiguous slice to start on
+		const unsigned int threadCount = GetThreadCount();
+		for (unsigned int worker = 0; worker < threadCount; worker++)
+		{
+			WorkQueue& queue = *m_Queues[worker];
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			unsigned int first = (unsigned int)((unsigned long long)count * worker / threadCount);
+			unsigned int last = (unsigned int)((unsigned long long)count * (worker + 1) / threadCount);
+			for (unsigned int index = first; index < last; index++)
+			{
+				queue.Tasks.push_back(index);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Task = &task;
+			m_BusyWorkers = (unsigned int)m_Threads.size();
+			m_Generation++;
+		}
+
+		m_WorkReady.notify_all();
+		RunTasks(0);
+
+		// Workers read task until they are done, so it has to outlive the wait even when a task threw
+		std::exception_ptr exception;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkDone.wait(lock, [this]() { return m_BusyWorkers == 0; });
+			m_Task = nullptr;
+			m_bFailed = false;
+			std::swap(exception, m_Exception);
+		}
+
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+
+	unsigned int ThreadPool::GetThreadCount() const
+	{
+		return (unsigned int)m_Threads.size() + 1;
+	}
+
+	void ThreadPool::ParallelFor(ThreadPool* pool, unsigned int count, const std::function<void(unsigned int, unsigned int)>& task)
+	{
+		if (pool)
+		{
+			pool->ParallelFor(count, task);
+			return;
+		}
+
+		for (unsigned int index = 0; index < count; index++)
+		{
+			task(index, 0);
+		}
+	}
+
+	unsigned int ThreadPool::GetThreadCount(const ThreadPool* pool)
+	{
+		return pool ? pool->GetThreadCount() : 1;
+	}
+
+	void ThreadPool::WorkerLoop(unsigned int worker)
+	{
+		unsigned long long seenGeneration = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_WorkReady.wait(lock, [&]() { return m_bStopping || m_Generation != seenGeneration; });
+				if (m_bStopping)
+					return;
+
+				seenGeneration = m_Generation;
+			}
+
+			RunTasks(worker);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_BusyWorkers == 0)
+				m_WorkDone.notify_one();
+		}
+	}
+
+	void ThreadPool::RunTasks(unsigned int worker)
+	{
+		ActivePoolScope scope(this);
+
+		// After a task throws the rest are still taken off the queues, but not run
+		unsigned int index;
+		while (PopTask(worker, index) || StealTask(worker, index))
+		{
+			if (m_bFailed)
+				continue;
+
+			try
+			{
+				(*m_Task)(index, worker);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (!m_Exception)
+					m_Exception = std::current_exception();
+
+				m_bFailed = true;
+			}
+		}
+	}
+
+	bool ThreadPool::PopTask(unsigned int worker, unsigned int& index)
+	{
+		WorkQueue& queue = *m_Queues[worker];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (queue.Tasks.empty())
+			return false;
+
+		index = queue.Tasks.front();
+		queue.Tasks.pop_front();
+		return true;
+	}
+
+	bool ThreadPool::StealTask(unsigned int worker, unsigned int& index)
+	{
+		// Take from the far end of another worker's slice to stay out of its way
+		const unsigned int threadCount = GetThreadCount();
+		for (unsigned int offset = 1; offset < threadCount; offset++)
+		{
+			WorkQueue& queue = *m_Queues[(worker + offset) % threadCount];
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (queue.Tasks.empty())
+				continue;
+
+			index = queue.Tasks.back();
+			queue.Tasks.pop_back();
+			return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace WorldGenerator
+{
+	// Fixed set of worker threads used to split generation work. The calling thread
+	// takes part in every ParallelFor as worker 0. Each worker starts on its own slice
+	// of the indices and steals from the others once it runs dry.
+	class ThreadPool
+	{
+	public:
+		// threadCount includes the calling thread. Zero uses one thread per hardware core
+		ThreadPool(unsigned int threadCount);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Runs task(index, worker) for every index in [0, count) and waits for all of them.
+		// Calls made from inside a task of this pool run inline on the calling worker. When a
+		// task throws, the tasks not yet started are skipped and the first exception is rethrown
+		// once every worker has stopped
+		void ParallelFor(unsigned int count, const std::function<void(unsigned int, unsigned int)>& task);
+
+		unsigned int GetThreadCount()const;
+
+		// Same as pool->ParallelFor, but runs every task on the calling thread as worker 0 when
+		// pool is null. Passes taking an optional pool loop through this
+		static void ParallelFor(ThreadPool* pool, unsigned int count, const std::function<void(unsigned int, unsigned int)>& task);
+
+		// Workers a loop on pool may use, 1 when pool is null
+		static unsigned int GetThreadCount(const ThreadPool* pool);
+
+	private:
+		struct WorkQueue
+		{
+			std::mutex Mutex;
+			std::deque<unsigned int> Tasks;
+		};
+
+		void WorkerLoop(unsigned int worker);
+		void RunTasks(unsigned int worker);
+		bool PopTask(unsigned int worker, unsigned int& index);
+		bool StealTask(unsigned int worker, unsigned int& index);
+
+		std::vector<std::thread> m_Threads;
+		std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+		std::mutex m_Mutex;
+		std::mutex m_ForMutex;
+		std::condition_variable m_WorkReady;
+		std::condition_variable m_WorkDone;
+		const std::function<void(unsigned int, unsigned int)>* m_Task;
+		unsigned int m_BusyWorkers;
+		// First exception thrown by a task of the current loop
+		std::exception_ptr m_Exception;
+		std::atomic<bool> m_bFailed;
+		unsigned long long m_Generation;
+		bool m_bStopping;
+	};
+}
@@ -0,0 +1,214 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "WalkerSet.h"
+#include <algorithm>
+
+namespace WorldGenerator
+{
+	// Headings in table order: east, south, west and north as (row, column) steps
+	static constexpr int HEADING_ROWS[4] = { 0, 1, 0, -1 };
+	static constexpr int HEADING_COLUMNS[4] = { 1, 0, -1, 0 };
+
+	// Index of a heading in the order above
+	static inline unsigned int GetHeadingIndex(int forwardRow, int forwardColumn)
+	{
+		return (forwardRow != 0 ? 1u : 0u) | ((forwardRow + forwardColumn) < 0 ? 2u : 0u);
+	}
+
+	// Moves for every heading and pair of row and column windows. 4 x 32 x 32 entries
+	struct MoveTable
+	{
+		unsigned char Entries[4 << 10];
+	};
+
+	static constexpr bool IsOpen(unsigned int rowWindow, unsigned int columnWindow, int row, int column)
+	{
+		return ((rowWindow >> (row + 2)) & (columnWindow >> (column + 2)) & 1) != 0;
+	}
+
+	// Going forward is allowed when the cell ahead is open. The walker may then turn onto an
+	// open side, as long as the cell behind it is open too. When the way ahead is closed it
+	// backs up a cell and has to turn, which needs the cell behind that and an open side.
+	// Right is (column, row) of the heading and left is its negation
+	static constexpr unsigned char GetMoves(unsigned int heading, unsigned int rowWindow, unsigned int columnWindow)
+	{
+		const int forwardRow = HEADING_ROWS[heading];
+		const int forwardColumn = HEADING_COLUMNS[heading];
+		const bool bAhead = IsOpen(rowWindow, columnWindow, forwardRow, forwardColumn);
+
+		// Turns are taken from the current cell, or from the one behind it when backing up
+		const int fromRow = bAhead ? 0 : -forwardRow;
+		const int fromColumn = bAhead ? 0 : -forwardColumn;
+		unsigned int moves = bAhead ? WalkerSet::GO_FORWARD : 0;
+		if (!IsOpen(rowWindow, columnWindow, fromRow - forwardRow, fromColumn - forwardColumn))
+			return (unsigned char)moves;
+
+		if (IsOpen(rowWindow, columnWindow, fromRow + forwardColumn, fromColumn + forwardRow))
+			moves |= WalkerSet::TURN_RIGHT;
+
+		if (IsOpen(rowWindow, columnWindow, fromRow - forwardColumn, fromColumn - forwardRow))
+			moves |= WalkerSet::TURN_LEFT;
+
+		if (!bAhead && moves)
+			moves |= WalkerSet::BACK_UP;
+
+		return (unsigned char)moves;
+	}
+
+	static constexpr MoveTable BuildMoveTable()
+	{
+		MoveTable table = {};
+		for (unsigned int heading = 0; heading < 4; heading++)
+		{
+			for (unsigned int rowWindow = 0; rowWindow < 32; rowWindow++)
+			{
+				for (unsigned int columnWindow = 0; columnWindow < 32; columnWindow++)
+				{
+					table.Entries[(heading << 10) | (rowWindow << 5) | columnWindow] = GetMoves(heading, rowWindow, columnWindow);
+				}
+			}
+		}
+
+		return table;
+	}
+
+	static constexpr MoveTable MOVE_TABLE = BuildMoveTable();
+
+	// Window bits for position index of an axis count positions long
+	static unsigned char GetWindow(int index, int count)
+	{
+		unsigned char window = 0;
+		for (int offset = -2; offset <= 2; offset++)
+		{
+			if (index + offset >= 0 && index + offset < count)
+				window |= (unsigned char)(1 << (offset + 2));
+		}
+
+		return window;
+	}
+
+	WalkerSet::WalkerSet()
+	{
+		m_Dimensions = std::make_pair(0, 0);
+		m_MaxLength = 0;
+	}
+
+	void WalkerSet::Reset(std::pair<int, int> dimensions, int maxLength)
+	{
+		m_Dimensions = dimensions;
+		m_MaxLength = maxLength;
+		m_Rows.clear();
+		m_Columns.clear();
+		m_ForwardRows.clear();
+		m_ForwardColumns.clear();
+		m_PathLengths.clear();
+		m_Ids.clear();
+		m_Moves.clear();
+		m_Active.clear();
+
+		m_RowWindows.resize(std::max(dimensions.first, 0));
+		for (int row = 0; row < (int)m_RowWindows.size(); row++)
+		{
+			m_RowWindows[row] = GetWindow(row, dimensions.first);
+		}
+
+		m_ColumnWindows.resize(std::max(dimensions.second, 0));
+		for (int column = 0; column < (int)m_ColumnWindows.size(); column++)
+		{
+			m_ColumnWindows[column] = GetWindow(column, dimensions.second);
+		}
+	}
+
+	void WalkerSet::Spawn(std::pair<int, int> location, std::pair<int, int> direction, unsigned int id)
+	{
+		m_Rows.push_back(location.first);
+		m_Columns.push_back(location.second);
+		m_ForwardRows.push_back(direction.first);
+		m_ForwardColumns.push_back(direction.second);
+		m_PathLengths.push_back(0);
+		m_Ids.push_back(id);
+		m_Moves.push_back(0);
+		m_Active.push_back(1);
+	}
+
+	void WalkerSet::UpdateMoves(unsigned int first, unsigned int last)
+	{
+		for (unsigned int index = first; index < last; index++)
+		{
+			const unsigned int heading = GetHeadingIndex(m_ForwardRows[index], m_ForwardColumns[index]);
+			m_Moves[index] = MOVE_TABLE.Entries[(heading << 10) | (m_RowWindows[m_Rows[index]] << 5) | m_ColumnWindows[m_Columns[index]]];
+		}
+	}
+
+	void WalkerSet::Compact(unsigned int count)
+	{
+		unsigned int kept = 0;
+		const unsigned int total = size();
+		for (unsigned int index = 0; index < total; index++)
+		{
+			if (index < count && !m_Active[index])
+				continue;
+
+			if (kept != index)
+			{
+				m_Rows[kept] = m_Rows[index];
+				m_Columns[kept] = m_Columns[index];
+				m_ForwardRows[kept] = m_ForwardRows[index];
+				m_ForwardColumns[kept] = m_ForwardColumns[index];
+				m_PathLengths[kept] = m_PathLengths[index];
+				m_Ids[kept] = m_Ids[index];
+				m_Active[kept] = m_Active[index];
+			}
+
+			kept++;
+		}
+
+		m_Rows.resize(kept);
+		m_Columns.resize(kept);
+		m_ForwardRows.resize(kept);
+		m_ForwardColumns.resize(kept);
+		m_PathLengths.resize(kept);
+		m_Ids.resize(kept);
+		m_Moves.resize(kept);
+		m_Active.resize(kept);
+	}
+
+	void WalkerSet::GetCarvedCells(unsigned int index, std::pair<int, int> cells[3]) const
+	{
+		const int row = m_Rows[index];
+		const int column = m_Columns[index];
+		cells[0] = std::make_pair(row, column);
+		cells[1] = std::make_pair(row - m_ForwardColumns[index], column - m_ForwardRows[index]);
+		cells[2] = std::make_pair(row + m_ForwardColumns[index], column + m_ForwardRows[index]);
+	}
+
+	std::pair<int, int> WalkerSet::GetLocation(unsigned int index) const
+	{
+		return std::make_pair(m_Rows[index], m_Columns[index]);
+	}
+
+	std::pair<int, int> WalkerSet::GetDirection(unsigned int index) const
+	{
+		return std::make_pair(m_ForwardRows[index], m_ForwardColumns[index]);
+	}
+
+	unsigned int WalkerSet::GetId(unsigned int index) const
+	{
+		return m_Ids[index];
+	}
+
+	bool WalkerSet::IsActive(unsigned int index) const
+	{
+		return m_Active[index] != 0;
+	}
+
+	unsigned int WalkerSet::size() const
+	{
+		return (unsigned int)m_Rows.size();
+	}
+
+	bool WalkerSet::empty() const
+	{
+		return m_Rows.empty();
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "GenerationStats.h"
+#include "Random.h"
+#include <vector>
+
+namespace WorldGenerator
+{
+	// Drunken walkers kept as parallel arrays instead of one object per walker. Walkers are
+	// stepped in index order and retired walkers are dropped by Compact without reordering
+	// the rest. Which way a walker may go is read from a table rather than worked out with
+	// bounds checks, and no step allocates.
+	class WalkerSet
+	{
+	public:
+		WalkerSet();
+
+		// Removes every walker. Walkers may not leave a map of dimensions and retire after maxLength steps
+		void Reset(std::pair<int, int> dimensions, int maxLength);
+
+		// Adds a walker after the existing ones. id is left for the caller, e.g. to pick a random stream
+		void Spawn(std::pair<int, int> location, std::pair<int, int> direction, unsigned int id = 0);
+
+		// Looks up which moves stay on the map for walkers [first, last). Has to be called
+		// before those walkers are stepped, and only reads the walkers in the range
+		void UpdateMoves(unsigned int first, unsigned int last);
+
+		// Turns and moves walker index. Returns false, and marks the walker retired, when it
+		// has walked its full path or has nowhere left to go
+		template<typename Engine>
+		bool Step(unsigned int index, Engine& rng, int strayPercentage, GenerationStats* stats);
+
+		// Drops the retired walkers among the first count, keeping everyone else in order
+		void Compact(unsigned int count);
+
+		// Gets the cells carved at walker index's location: the center and both sides
+		void GetCarvedCells(unsigned int index, std::pair<int, int> cells[3])const;
+
+		std::pair<int, int> GetLocation(unsigned int index)const;
+		std::pair<int, int> GetDirection(unsigned int index)const;
+		unsigned int GetId(unsigned int index)const;
+		bool IsActive(unsigned int index)const;
+		unsigned int size()const;
+		bool empty()const;
+
+		// Ways a walker may go, as stored in the move table
+		enum MoveBit
+		{
+			GO_FORWARD = 1,
+			TURN_RIGHT = 2,
+			TURN_LEFT = 4,
+			// The way ahead is off the map, so the walker backs up a cell and turns
+			BACK_UP = 8,
+		};
+
+	private:
+		std::vector<int> m_Rows;
+		std::vector<int> m_Columns;
+		std::vector<int> m_ForwardRows;
+		std::vector<int> m_ForwardColumns;
+		std::vector<int> m_PathLengths;
+		std::vector<unsigned int> m_Ids;
+		std::vector<unsigned char> m_Moves;
+		std::vector<unsigned char> m_Active;
+		// Bit k is set when row (or column) index + k - 2 is on the map. Positions past the
+		// edges act as a two cell sentinel border, so looking moves up needs no range checks
+		std::vector<unsigned char> m_RowWindows;
+		std::vector<unsigned char> m_ColumnWindows;
+		std::pair<int, int> m_Dimensions;
+		int m_MaxLength;
+	};
+
+	template<typename Engine>
+	bool WalkerSet::Step(unsigned int index, Engine& rng, int strayPercentage, GenerationStats* stats)
+	{
+		if (m_PathLengths[index] > m_MaxLength)
+		{
+			m_Active[index] = 0;
+			return false;
+		}
+
+		const unsigned int moves = m_Moves[index];
+		if (!(moves & (GO_FORWARD | BACK_UP)))
+		{
+			WORLDGEN_STAT(stats, DeadEnds++);
+			m_Active[index] = 0;
+			return false;
+		}
+
+		const int forwardRow = m_ForwardRows[index];
+		const int forwardColumn = m_ForwardColumns[index];
+		const unsigned int turns = moves & (TURN_RIGHT | TURN_LEFT);
+		if (moves & BACK_UP)
+		{
+			WORLDGEN_STAT(stats, FrontBlocked++);
+			m_Rows[index] -= forwardRow;
+			m_Columns[index] -= forwardColumn;
+		}
+
+		// A walker that backed up has to turn, others stray onto a side that is open
+		if ((moves & BACK_UP) || (turns && strayPercentage >= UniformRange(rng, 0, 100)))
+		{
+			bool bRight = (turns == (TURN_RIGHT | TURN_LEFT)) ? UniformBool(rng) : (turns == TURN_RIGHT);
+			m_ForwardRows[index] = bRight ? forwardColumn : -forwardColumn;
+			m_ForwardColumns[index] = bRight ? forwardRow : -forwardRow;
+		}
+
+		m_PathLengths[index]++;
+		m_Rows[index] += m_ForwardRows[index];
+		m_Columns[index] += m_ForwardColumns[index];
+		WORLDGEN_STAT(stats, WalkerSteps++);
+
+		return true;
+	}
+}
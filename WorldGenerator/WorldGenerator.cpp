@@ -2,12 +2,12 @@
 
 #include <iostream>
 #include "Generator.h"
+#include "MapExporter.h"
 
 using namespace WorldGenerator;
 using namespace std;
 
 void PrintGrid(WorldGrid& grid);
-char GetCellSymbol(CellType type);
 
 int main()
 {
@@ -41,40 +41,9 @@ int main()
 
 void PrintGrid(WorldGrid& grid)
 {
-	std::string gridStr;
-	unsigned int ymax = (int)grid.ColumnCount() - 1;
-	for (int y = ymax; y >= 0; y--)
-	{
-		for (int x = 0; x < (int)grid.RowCount(); x++)
-		{
-			gridStr += GetCellSymbol(grid[x][y].Type);
-		}
-
-		gridStr += '\n';
-	}
+	MapExporter exporter;
+	exporter.SetTransposed(true);
 
-	cout << gridStr;
-}
-
-char GetCellSymbol(CellType type)
-{
-	switch (type)
-	{
-	case WorldGenerator::CellType::Ground:
-		return '.';
-	case WorldGenerator::CellType::LeftWall:
-	case WorldGenerator::CellType::RightWall:
-		return '|';
-	case WorldGenerator::CellType::TopWall:
-	case WorldGenerator::CellType::BottomWall:
-		return '-';
-	case WorldGenerator::CellType::TRCornerWall:
-	case WorldGenerator::CellType::BLCornerWall:
-		return '\\';
-	case WorldGenerator::CellType::TLCornerWall:
-	case WorldGenerator::CellType::BRCornerWall:
-		return '/';
-	default:
-		return ' ';
-	}
+	StreamSink sink(cout);
+	exporter.Export(grid, MapExporter::ASCII, sink);
 }
@@ -0,0 +1,179 @@
+// Created by Eric Marquez. All rights reserved
+
+#include "WorldGrid.h"
+#include "Simd.h"
+#include <cstddef>
+
+namespace WorldGenerator
+{
+	// RebuildLayers reads the Passable and Type bytes straight out of each packed Cell
+	static_assert(offsetof(Cell, Passable) == 2 && offsetof(Cell, Type) == 3 && sizeof(Cell) == 4, "RebuildLayers expects the packed Cell layout");
+
+	WorldGrid::WorldGrid() :
+		m_TypeLayers(CellSet::PALETTE_SIZE)
+	{
+	}
+
+	WorldGrid::WorldGrid(int rows, int columns, const Cell& value) :
+		m_TypeLayers(CellSet::PALETTE_SIZE)
+	{
+		assign(rows, columns, value);
+	}
+
+	void WorldGrid::resize(int rows, int columns, const Cell& value)
+	{
+		FlatGrid<Cell>::resize(rows, columns, value);
+		RebuildLayers();
+	}
+
+	void WorldGrid::assign(int rows, int columns, const Cell& value)
+	{
+		FlatGrid<Cell>::assign(rows, columns, value);
+
+		m_PassableLayer.assign(rows, columns, value.Passable);
+		for (unsigned int index = 0; index < m_TypeLayers.size(); index++)
+		{
+			m_TypeLayers[index].assign(rows, columns, index == CellSet::GetPaletteIndex(value.Type));
+		}
+	}
+
+	void WorldGrid::clear()
+	{
+		FlatGrid<Cell>::clear();
+
+		m_PassableLayer.clear();
+		for (BitGrid& layer : m_TypeLayers)
+		{
+			layer.clear();
+		}
+	}
+
+	void WorldGrid::SetCell(int x, int y, const Cell& cell)
+	{
+		Cell& current = (*this)[x][y];
+		m_TypeLayers[CellSet::GetPaletteIndex(current.Type)].Set(x, y, false);
+
+		current = cell;
+		m_PassableLayer.Set(x, y, cell.Passable);
+		m_TypeLayers[CellSet::GetPaletteIndex(cell.Type)].Set(x, y, true);
+	}
+
+	const Cell& WorldGrid::GetCell(int x, int y) const
+	{
+		return (*this)[x][y];
+	}
+
+	void WorldGrid::RebuildLayers()
+	{
+		RebuildLayers(0, (int)RowCount());
+	}
+
+	void WorldGrid::RebuildLayers(int firstRow, int lastRow)
+	{
+		RebuildLayers(std::make_pair(firstRow, lastRow), std::make_pair(0, (int)ColumnCount()));
+	}
+
+	void WorldGrid::RebuildLayers(std::pair<int, int> rowRange, std::pair<int, int> columnRange)
+	{
+		const int rows = (int)RowCount();
+		const int columns = (int)ColumnCount();
+		if (m_PassableLayer.RowCount() != (unsigned int)rows || m_PassableLayer.ColumnCount() != (unsigned int)columns)
+		{
+			m_PassableLayer.assign(rows, columns);
+			for (BitGrid& layer : m_TypeLayers)
+			{
+				layer.assign(rows, columns);
+			}
+		}
+
+		// Build each 64 cell word of every layer in registers, then store them all at once.
+		// Each word is written whole from its cells, so nothing needs clearing first
+		const unsigned int typeCount = (unsigned int)m_TypeLayers.size();
+		unsigned long long typeWords[CellSet::PALETTE_SIZE];
+		const int firstRow = std::max(rowRange.first, 0);
+		const int lastRow = std::min(rowRange.second, rows);
+		const int wordBits = (int)BitGrid::WORD_BITS;
+		const int firstWord = std::max(columnRange.first, 0) / wordBits;
+		const int lastWord = std::min((std::min(columnRange.second, columns) + wordBits - 1) / wordBits, (int)m_PassableLayer.WordsPerRow());
+		for (int x = firstRow; x < lastRow; x++)
+		{
+			const Cell* cells = (*this)[x].data();
+			for (int word = firstWord; word < lastWord; word++)
+			{
+				const int first = word * BitGrid::WORD_BITS;
+				const int count = std::min((int)BitGrid::WORD_BITS, columns - first);
+				unsigned long long passable = 0;
+				std::fill_n(typeWords, typeCount, 0ULL);
+
+				int index = 0;
+#ifdef WORLDGEN_SSE2
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i lowByte = _mm_set1_epi16(0xFF);
+				for (; index + 16 <= count; index += 16)
+				{
+					// Shift each cell down to its Passable and Type bytes, then narrow 16 cells
+					// into one vector of Passable bytes and one of Type bytes
+					const __m128i* source = (const __m128i*)(cells + first + index);
+					__m128i low = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(source), 16), _mm_srli_epi32(_mm_loadu_si128(source + 1), 16));
+					__m128i high = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(source + 2), 16), _mm_srli_epi32(_mm_loadu_si128(source + 3), 16));
+					__m128i flags = _mm_packus_epi16(_mm_and_si128(low, lowByte), _mm_and_si128(high, lowByte));
+					__m128i types = _mm_packus_epi16(_mm_srli_epi16(low, 8), _mm_srli_epi16(high, 8));
+
+					unsigned long long passableBits = ~_mm_movemask_epi8(_mm_cmpeq_epi8(flags, zero)) & 0xFFFF;
+					passable |= passableBits << index;
+					for (unsigned int type = 0; type < typeCount; type++)
+					{
+						unsigned long long typeBits = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(types, _mm_set1_epi8((char)type)));
+						typeWords[type] |= typeBits << index;
+					}
+				}
+#endif
+				for (; index < count; index++)
+				{
+					const Cell& cell = cells[first + index];
+					unsigned char type = CellSet::GetPaletteIndex(cell.Type);
+					if (cell.Passable)
+						passable |= 1ULL << index;
+					if (type < typeCount)
+						typeWords[type] |= 1ULL << index;
+				}
+
+				m_PassableLayer.RowWords(x)[word] = passable;
+				for (unsigned int type = 0; type < typeCount; type++)
+				{
+					m_TypeLayers[type].RowWords(x)[word] = typeWords[type];
+				}
+			}
+		}
+	}
+
+	bool WorldGrid::IsPassable(int x, int y) const
+	{
+		return m_PassableLayer.Get(x, y);
+	}
+
+	const BitGrid& WorldGrid::GetPassableLayer() const
+	{
+		return m_PassableLayer;
+	}
+
+	const BitGrid& WorldGrid::GetGroundLayer() const
+	{
+		return GetTypeLayer(CellType::Ground);
+	}
+
+	const BitGrid& WorldGrid::GetTypeLayer(CellType type) const
+	{
+		return m_TypeLayers[CellSet::GetPaletteIndex(type)];
+	}
+
+	size_t WorldGrid::CountPassable(std::pair<int, int> rowRange, std::pair<int, int> columnRange) const
+	{
+		return m_PassableLayer.Count(rowRange, columnRange);
+	}
+
+	size_t WorldGrid::CountType(CellType type, std::pair<int, int> rowRange, std::pair<int, int> columnRange) const
+	{
+		return GetTypeLayer(type).Count(rowRange, columnRange);
+	}
+}
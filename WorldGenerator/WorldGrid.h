@@ -0,0 +1,67 @@
+#pragma once
+// Created by Eric Marquez. All rights reserved
+
+#include "Cell.h"
+#include "FlatGrid.h"
+#include "BitGrid.h"
+
+namespace WorldGenerator
+{
+	// Row-major grid of cells. grid[x][y] addresses row x, column y.
+	// Alongside the cells it keeps bit layers for passability and for each CellType,
+	// so collision and area queries can test 64 cells per word instead of reading Cells.
+	// SetCell keeps the layers in sync. Cells written through rows or spans need a
+	// RebuildLayers call before the layers are read again.
+	class WorldGrid : public FlatGrid<Cell>
+	{
+	public:
+		WorldGrid();
+
+		WorldGrid(int rows, int columns, const Cell& value = Cell());
+
+		// Resizes the grid, keeping the overlapping cells, and rebuilds the layers
+		void resize(int rows, int columns, const Cell& value = Cell());
+
+		// Fills the grid with a single value and resets the layers to match
+		void assign(int rows, int columns, const Cell& value = Cell());
+
+		void clear();
+
+		// Writes a cell and updates its bit in every layer
+		void SetCell(int x, int y, const Cell& cell);
+
+		const Cell& GetCell(int x, int y)const;
+
+		// Recomputes every layer from the cells in one pass
+		void RebuildLayers();
+
+		// Recomputes the layers for rows [firstRow, lastRow) only. Layers are resized first when
+		// the grid's size has changed, so calls that together cover every row match RebuildLayers()
+		void RebuildLayers(int firstRow, int lastRow);
+
+		// Recomputes the layers over [rowRange.first, rowRange.second) x [columnRange.first, columnRange.second),
+		// widened to whole layer words. Calls for areas sharing no row may run at the same time
+		// once the layers have the grid's size
+		void RebuildLayers(std::pair<int, int> rowRange, std::pair<int, int> columnRange);
+
+		bool IsPassable(int x, int y)const;
+
+		const BitGrid& GetPassableLayer()const;
+
+		const BitGrid& GetGroundLayer()const;
+
+		// Bit layer of the cells with the given type
+		const BitGrid& GetTypeLayer(CellType type)const;
+
+		// Counts passable cells in [rowRange.first, rowRange.second) x [columnRange.first, columnRange.second)
+		size_t CountPassable(std::pair<int, int> rowRange, std::pair<int, int> columnRange)const;
+
+		// Counts cells of the given type in [rowRange.first, rowRange.second) x [columnRange.first, columnRange.second)
+		size_t CountType(CellType type, std::pair<int, int> rowRange, std::pair<int, int> columnRange)const;
+
+	private:
+		BitGrid m_PassableLayer;
+		// One layer per palette index
+		std::vector<BitGrid> m_TypeLayers;
+	};
+}